@@ -34,4 +34,7 @@
 
 - (void)collectionViewLayoutWasInvalidated:(JNWCollectionViewLayout *)layout;
 
+/// Updates the cells for geometry the layout has changed in place, without preparing it again.
+- (void)collectionViewLayout:(JNWCollectionViewLayout *)layout didChangeSectionGeometryAnimated:(BOOL)animated;
+
 @end
@@ -20,8 +20,19 @@
 #import <Cocoa/Cocoa.h>
 #import "JNWCollectionViewFramework.h"
 #import "JNWCollectionViewCell.h"
+#import "JNWCollectionViewLightweightCell.h"
+#import "JNWCollectionViewThumbnailCache.h"
+#import "JNWCollectionViewMappedRecordDataSource.h"
+#import "JNWCollectionViewPagedDataSource.h"
+#import "JNWCollectionViewInMemoryPagedBackend.h"
+#import "JNWCollectionViewProjection.h"
 #import "JNWCollectionViewReusableView.h"
+#import "JNWCollectionViewReusePool.h"
 #import "JNWCollectionViewLayout.h"
 #import "JNWCollectionViewListLayout.h"
+#import "JNWCollectionViewListLayoutGeometry.h"
 #import "JNWCollectionViewGridLayout.h"
+#import "JNWCollectionViewFlowLayout.h"
+#import "JNWCollectionViewMasonryLayout.h"
+#import "JNWCollectionViewSpreadsheetLayout.h"
 #import "NSIndexPath+JNWAdditions.h"
@@ -20,12 +20,23 @@
 
 #import "JNWCollectionViewFramework.h"
 
+@class JNWCollectionViewLayoutAttributes;
 @interface JNWCollectionViewCell ()
 
 @property (nonatomic, copy, readwrite) NSString *reuseIdentifier;
 @property (nonatomic, weak, readwrite) JNWCollectionView *collectionView;
 @property (nonatomic, strong, readwrite) NSIndexPath *indexPath;
 
+/// The layout attributes that were last applied to the cell, used to skip re-applying
+/// unchanged attributes. Cleared when the cell is put back in the reuse queue.
+@property (nonatomic, strong) JNWCollectionViewLayoutAttributes *appliedLayoutAttributes;
+
+/// Whether instances create the background view and lazily create a content view.
+/// Subclasses that manage their own (layer-only) hierarchy return NO.
+///
+/// Defaults to YES.
++ (BOOL)wantsDefaultViewHierarchy;
+
 /// The image displayed on the dragging item when a cell is dragged out of its collection view.
 /// You can subclass and override this to return a different image, or nil to display nothing.
 - (NSImage *)draggingImageRepresentation;
@@ -93,15 +93,22 @@
 	return self;
 }
 
++ (BOOL)wantsDefaultViewHierarchy {
+	return YES;
+}
+
 - (void)_commonInit {
 	self.wantsLayer = YES;
 	self.layerContentsRedrawPolicy = NSViewLayerContentsRedrawOnSetNeedsDisplay;
 
+	_crossfadeDuration = 0.25;
+
+	if (![self.class wantsDefaultViewHierarchy])
+		return;
+
 	_backgroundView = [[JNWCollectionViewCellBackgroundView alloc] initWithFrame:self.bounds];
 	_backgroundView.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
 
-	_crossfadeDuration = 0.25;
-
 	[self addSubview:_backgroundView positioned:NSWindowBelow relativeTo:nil];
 }
 
@@ -125,6 +132,10 @@
 		[self removeTrackingArea:self.trackingArea];
 		self.trackingArea = nil;
 	}
+	
+	// The collection view is tracking the mouse for all of its cells.
+	if (self.collectionView.usesSingleTrackingArea)
+		return;
 
 	NSTrackingAreaOptions options = (NSTrackingActiveAlways | NSTrackingInVisibleRect | NSTrackingMouseEnteredAndExited | NSTrackingMouseMoved);
 	self.trackingArea = [[NSTrackingArea alloc] initWithRect:[self bounds] options:options owner:self userInfo:nil];
@@ -132,7 +143,7 @@
 }
 
 - (NSView *)contentView {
-	if (_contentView == nil) {
+	if (_contentView == nil && [self.class wantsDefaultViewHierarchy]) {
 		_contentView = [[NSView alloc] initWithFrame:self.bounds];
 		[self configureContentView:_contentView];
 	}
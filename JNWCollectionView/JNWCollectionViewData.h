@@ -36,6 +36,11 @@ typedef struct  {
 /// re-preparing the layout.
 - (void)recalculateAndPrepareLayout:(BOOL)prepareLayout;
 
+/// Recalculates the local section cache during a live resize. If the layout needs to be
+/// prepared, it is given the chance to update only its size-dependent geometry, without the
+/// data source being asked for the number of items again.
+- (void)recalculateAndPrepareLayoutForLiveResize:(BOOL)prepareLayout;
+
 /// The number of sections that the data source has reported.
 @property (nonatomic, assign, readonly) NSInteger numberOfSections;
 
@@ -50,6 +50,14 @@
 	return self.sections[section].numberOfItems;
 }
 
+- (void)recalculateAndPrepareLayoutForLiveResize:(BOOL)prepareLayout {
+	if (prepareLayout && _sectionData != nil && [self.collectionView.collectionViewLayout prepareLayoutForLiveResize]) {
+		prepareLayout = NO;
+	}
+	
+	[self recalculateAndPrepareLayout:prepareLayout];
+}
+
 - (void)recalculateAndPrepareLayout:(BOOL)prepareLayout {
 	JNWCollectionViewLayout *layout = self.collectionView.collectionViewLayout;
 	
@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewLayout.h"
+
+@class JNWCollectionViewFlowLayout;
+
+/// The supplementary view kind identifiers used for the header and the footer.
+extern NSString * const JNWCollectionViewFlowLayoutHeaderKind;
+extern NSString * const JNWCollectionViewFlowLayoutFooterKind;
+
+/// The ways items can be arranged within a line.
+typedef NS_ENUM(NSInteger, JNWCollectionViewFlowLayoutLineStyle) {
+	/// As many items as fit are placed in each line at their own size, starting at the left edge.
+	JNWCollectionViewFlowLayoutLineStyleLeftAligned,
+	
+	/// Items are added to a line until it is full, after which all items in the line are scaled
+	/// down proportionally so the line exactly fills the width. The last line is not scaled.
+	///
+	/// Items should be sized at the desired line height, with the width matching their aspect ratio.
+	JNWCollectionViewFlowLayoutLineStyleJustified
+};
+
+/// The delegate is responsible for returning size information for the flow layout.
+@protocol JNWCollectionViewFlowLayoutDelegate <NSObject>
+
+/// Asks the delegate for the size of the item at the specified index path.
+- (CGSize)collectionView:(JNWCollectionView *)collectionView sizeForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+@optional
+
+/// Asks the delegate for the height of the header or footer in the specified section.
+///
+/// The default height for both the header and footer is 0.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForHeaderInSection:(NSInteger)index;
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForFooterInSection:(NSInteger)index;
+
+/// Asks the delegate for section insets for a section in the flow layout.
+///
+/// The default is (0, 0, 0, 0).
+- (NSEdgeInsets)collectionView:(JNWCollectionView *)collectionView layout:(JNWCollectionViewFlowLayout *)collectionViewLayout insetForSectionAtIndex:(NSInteger)section;
+
+@end
+
+/// A layout subclass that places items of different sizes next to each other, and starts
+/// a new line once the width of the collection view has been filled.
+///
+/// Item sizes are cached, so resizing the collection view only re-breaks the lines without
+/// asking the delegate for any sizes.
+@interface JNWCollectionViewFlowLayout : JNWCollectionViewLayout
+
+/// The delegate for the flow layout. The delegate should be set before the
+/// collection view is reloaded.
+@property (nonatomic, unsafe_unretained) id<JNWCollectionViewFlowLayoutDelegate> delegate;
+
+/// Determines how items are arranged within a line.
+///
+/// Defaults to JNWCollectionViewFlowLayoutLineStyleLeftAligned.
+@property (nonatomic, assign) JNWCollectionViewFlowLayoutLineStyle lineStyle;
+
+/// The horizontal spacing between adjacent items in a line.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) CGFloat interitemSpacing;
+
+/// The vertical spacing between lines.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) CGFloat lineSpacing;
+
+/// Informs the layout that the items in the section starting at the index path have been
+/// inserted, deleted or resized, and that the items before it are unchanged.
+///
+/// The next time the layout is prepared, such as after -invalidateLayout, only the items from the
+/// index path onwards are asked for their sizes, and only the lines from the one containing the
+/// index path onwards are recalculated. Other sections are left untouched, apart from being moved.
+///
+/// Items inserted or deleted through the collection view are noted automatically. Without either,
+/// every item size is requested again whenever the layout is prepared, and so it is whenever the
+/// number of sections changes.
+- (void)noteItemsChangedFromIndexPath:(NSIndexPath *)indexPath;
+
+@end
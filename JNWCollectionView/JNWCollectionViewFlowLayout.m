@@ -0,0 +1,483 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewFlowLayout.h"
+
+NSString * const JNWCollectionViewFlowLayoutHeaderKind = @"JNWCollectionViewFlowLayoutHeader";
+NSString * const JNWCollectionViewFlowLayoutFooterKind = @"JNWCollectionViewFlowLayoutFooter";
+
+static BOOL JNWEdgeInsetsEqual(NSEdgeInsets a, NSEdgeInsets b) {
+	return (a.top == b.top && a.left == b.left && a.bottom == b.bottom && a.right == b.right);
+}
+
+@interface JNWCollectionViewFlowLayoutSection : NSObject
+@property (nonatomic, assign) NSInteger index;
+@property (nonatomic, assign) CGFloat offset;
+@property (nonatomic, assign) CGFloat headerHeight;
+@property (nonatomic, assign) CGFloat footerHeight;
+@property (nonatomic, assign) NSEdgeInsets insets;
+@property (nonatomic, assign) NSInteger numberOfItems;
+@property (nonatomic, assign, readonly) CGSize *itemSizes;
+@property (nonatomic, assign, readonly) CGRect *itemFrames; // relative to the top of the section
+@property (nonatomic, assign) NSInteger numberOfLines;
+@property (nonatomic, assign, readonly) NSInteger *lineStarts; // the index of the first item in each line
+@property (nonatomic, assign, readonly) CGFloat *lineOffsets; // relative to the top of the section
+@property (nonatomic, assign, readonly) CGFloat *lineHeights;
+@property (nonatomic, assign, readonly) CGFloat itemsOffset;
+@property (nonatomic, assign, readonly) CGFloat height;
+- (NSInteger)lineForItem:(NSInteger)item;
+- (NSInteger)lineEndingBelowOffset:(CGFloat)offset;
+- (NSInteger)endOfLine:(NSInteger)line;
+@end
+
+@implementation JNWCollectionViewFlowLayoutSection
+
+- (void)dealloc {
+	free(_itemSizes);
+	free(_itemFrames);
+	free(_lineStarts);
+	free(_lineOffsets);
+	free(_lineHeights);
+}
+
+- (void)setNumberOfItems:(NSInteger)numberOfItems {
+	// There are never more lines than items, so the line arrays share the item capacity.
+	NSInteger capacity = MAX(numberOfItems, 1);
+	_itemSizes = realloc(_itemSizes, capacity * sizeof(CGSize));
+	_itemFrames = realloc(_itemFrames, capacity * sizeof(CGRect));
+	_lineStarts = realloc(_lineStarts, capacity * sizeof(NSInteger));
+	_lineOffsets = realloc(_lineOffsets, capacity * sizeof(CGFloat));
+	_lineHeights = realloc(_lineHeights, capacity * sizeof(CGFloat));
+	_numberOfItems = numberOfItems;
+	_numberOfLines = MIN(_numberOfLines, numberOfItems);
+}
+
+- (CGFloat)itemsOffset {
+	return self.headerHeight + self.insets.top;
+}
+
+- (CGFloat)height {
+	CGFloat itemsHeight = 0;
+	if (_numberOfLines > 0) {
+		itemsHeight = _lineOffsets[_numberOfLines - 1] + _lineHeights[_numberOfLines - 1] - self.itemsOffset;
+	}
+	
+	return self.itemsOffset + itemsHeight + self.insets.bottom + self.footerHeight;
+}
+
+/// Returns the index of the line containing the item, or of the last line if the item is
+/// past the end of the laid out items.
+- (NSInteger)lineForItem:(NSInteger)item {
+	NSInteger low = 0;
+	NSInteger high = _numberOfLines - 1;
+	NSInteger result = 0;
+	
+	while (low <= high) {
+		NSInteger mid = (low + high) / 2;
+		if (_lineStarts[mid] <= item) {
+			result = mid;
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	
+	return result;
+}
+
+/// Returns the first line ending below the offset relative to the top of the section, or
+/// the number of lines if there is none.
+- (NSInteger)lineEndingBelowOffset:(CGFloat)offset {
+	NSInteger low = 0;
+	NSInteger high = _numberOfLines;
+	
+	while (low < high) {
+		NSInteger mid = (low + high) / 2;
+		if (_lineOffsets[mid] + _lineHeights[mid] > offset) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	
+	return low;
+}
+
+- (NSInteger)endOfLine:(NSInteger)line {
+	return (line + 1 < _numberOfLines ? _lineStarts[line + 1] : _numberOfItems);
+}
+
+@end
+
+@interface JNWCollectionViewFlowLayout()
+@property (nonatomic, strong) NSMutableArray *sections;
+@property (nonatomic, assign) CGRect lastInvalidatedBounds;
+@property (nonatomic, assign) BOOL onlyBoundsChanged;
+@property (nonatomic, strong) NSMutableDictionary *changedItems; // first changed item keyed by section
+@property (nonatomic, assign) CGFloat preparedWidth;
+@property (nonatomic, assign) CGFloat preparedInteritemSpacing;
+@property (nonatomic, assign) CGFloat preparedLineSpacing;
+@property (nonatomic, assign) JNWCollectionViewFlowLayoutLineStyle preparedLineStyle;
+@end
+
+@implementation JNWCollectionViewFlowLayout
+
+- (NSMutableArray *)sections {
+	if (_sections == nil) {
+		_sections = [NSMutableArray array];
+	}
+	return _sections;
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds {
+	if (newBounds.size.width != self.lastInvalidatedBounds.size.width) {
+		self.lastInvalidatedBounds = newBounds;
+		// Item sizes don't depend on the width, so only the lines need to be broken again.
+		self.onlyBoundsChanged = YES;
+		return YES;
+	}
+	
+	return NO;
+}
+
+- (void)noteItemsChangedFromIndexPath:(NSIndexPath *)indexPath {
+	if (self.changedItems == nil) {
+		self.changedItems = [NSMutableDictionary dictionary];
+	}
+	
+	NSNumber *section = @(indexPath.jnw_section);
+	NSNumber *existingItem = self.changedItems[section];
+	if (existingItem == nil || existingItem.integerValue > indexPath.jnw_item) {
+		self.changedItems[section] = @(indexPath.jnw_item);
+	}
+}
+
+- (void)willUpdateItemsDeletingItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertingItemsAtIndexPaths:(NSArray *)insertedIndexPaths {
+	// The items before the first deleted one and the first inserted one are the same before and after the update.
+	for (NSIndexPath *indexPath in deletedIndexPaths) {
+		[self noteItemsChangedFromIndexPath:indexPath];
+	}
+	for (NSIndexPath *indexPath in insertedIndexPaths) {
+		[self noteItemsChangedFromIndexPath:indexPath];
+	}
+}
+
+- (void)prepareLayout {
+	if (self.delegate != nil && ![self.delegate conformsToProtocol:@protocol(JNWCollectionViewFlowLayoutDelegate)]) {
+		NSLog(@"*** flow delegate does not conform to JNWCollectionViewFlowLayoutDelegate!");
+	}
+	
+	BOOL delegateHeightForHeader = [self.delegate respondsToSelector:@selector(collectionView:heightForHeaderInSection:)];
+	BOOL delegateHeightForFooter = [self.delegate respondsToSelector:@selector(collectionView:heightForFooterInSection:)];
+	BOOL delegateForSectionInsets = [self.delegate respondsToSelector:@selector(collectionView:layout:insetForSectionAtIndex:)];
+	JNWCollectionView *collectionView = self.collectionView;
+	
+	// Previously measured items are only reused when we know what has changed. Otherwise this
+	// is a reload, and every item could have a different size.
+	NSDictionary *changedItems = self.changedItems;
+	BOOL reusesItems = (self.onlyBoundsChanged || changedItems != nil);
+	NSArray *previousSections = [self.sections copy];
+	self.onlyBoundsChanged = NO;
+	self.changedItems = nil;
+	
+	CGFloat width = collectionView.visibleSize.width;
+	BOOL linesChanged = (width != self.preparedWidth || self.interitemSpacing != self.preparedInteritemSpacing ||
+						 self.lineSpacing != self.preparedLineSpacing || self.lineStyle != self.preparedLineStyle);
+	
+	[self.sections removeAllObjects];
+	
+	NSUInteger numberOfSections = [collectionView numberOfSections];
+	CGFloat totalHeight = 0;
+	
+	// Sections are matched up by index, so once sections have been inserted or deleted, a section
+	// could be matched with the sizes of another one.
+	if (numberOfSections != previousSections.count) {
+		reusesItems = NO;
+	}
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		NSInteger numberOfItems = [collectionView numberOfItemsInSection:sectionIdx];
+		CGFloat headerHeight = delegateHeightForHeader ? [self.delegate collectionView:collectionView heightForHeaderInSection:sectionIdx] : 0;
+		CGFloat footerHeight = delegateHeightForFooter ? [self.delegate collectionView:collectionView heightForFooterInSection:sectionIdx] : 0;
+		NSEdgeInsets insets = delegateForSectionInsets ? [self.delegate collectionView:collectionView layout:self insetForSectionAtIndex:sectionIdx] : NSEdgeInsetsMake(0, 0, 0, 0);
+		
+		JNWCollectionViewFlowLayoutSection *section = nil;
+		NSInteger firstChangedItem = 0;
+		
+		if (reusesItems && sectionIdx < previousSections.count) {
+			section = previousSections[sectionIdx];
+			NSNumber *changedItem = changedItems[@(sectionIdx)];
+			
+			if (changedItem != nil) {
+				firstChangedItem = MIN(changedItem.integerValue, MIN(numberOfItems, section.numberOfItems));
+			} else if (section.numberOfItems == numberOfItems) {
+				firstChangedItem = numberOfItems;
+			}
+		} else {
+			section = [[JNWCollectionViewFlowLayoutSection alloc] init];
+		}
+		
+		BOOL sectionLinesChanged = (linesChanged || headerHeight != section.headerHeight || !JNWEdgeInsetsEqual(insets, section.insets));
+		BOOL itemsChanged = (firstChangedItem < numberOfItems || numberOfItems != section.numberOfItems);
+		
+		section.index = sectionIdx;
+		section.offset = totalHeight;
+		section.headerHeight = headerHeight;
+		section.footerHeight = footerHeight;
+		section.insets = insets;
+		section.numberOfItems = numberOfItems;
+		
+		for (NSInteger item = firstChangedItem; item < numberOfItems; item++) {
+			NSIndexPath *indexPath = [NSIndexPath jnw_indexPathForItem:item inSection:sectionIdx];
+			section.itemSizes[item] = [self.delegate collectionView:collectionView sizeForItemAtIndexPath:indexPath];
+		}
+		
+		if (sectionLinesChanged) {
+			[self breakLinesInSection:section fromItem:0 width:width];
+		} else if (itemsChanged) {
+			[self breakLinesInSection:section fromItem:firstChangedItem width:width];
+		}
+		
+		totalHeight += section.height;
+		[self.sections addObject:section];
+	}
+	
+	self.preparedWidth = width;
+	self.preparedInteritemSpacing = self.interitemSpacing;
+	self.preparedLineSpacing = self.lineSpacing;
+	self.preparedLineStyle = self.lineStyle;
+}
+
+/// Recalculates the lines of the section starting with the line containing the item. The
+/// lines before it are kept as they are.
+- (void)breakLinesInSection:(JNWCollectionViewFlowLayoutSection *)section fromItem:(NSInteger)firstItem width:(CGFloat)width {
+	NSInteger line = (firstItem > 0 && section.numberOfLines > 0 ? [section lineForItem:firstItem] : 0);
+	
+	// If the first changed item starts a line, it might fit at the end of the previous line now.
+	if (line > 0 && section.lineStarts[line] == firstItem) {
+		line--;
+	}
+	
+	NSInteger item = (line > 0 ? section.lineStarts[line] : 0);
+	CGFloat y = (line > 0 ? section.lineOffsets[line - 1] + section.lineHeights[line - 1] + self.lineSpacing : section.itemsOffset);
+	
+	NSEdgeInsets insets = section.insets;
+	CGFloat availableWidth = width - insets.left - insets.right;
+	CGFloat spacing = self.interitemSpacing;
+	BOOL justified = (self.lineStyle == JNWCollectionViewFlowLayoutLineStyleJustified);
+	
+	while (item < section.numberOfItems) {
+		NSInteger lineStart = item;
+		CGFloat itemsWidth = 0;
+		
+		// Left aligned lines take items as long as they fit. Justified lines take items until
+		// they overflow, and are then scaled down to fit.
+		while (item < section.numberOfItems) {
+			CGFloat itemWidth = section.itemSizes[item].width;
+			CGFloat lineWidth = itemsWidth + (item > lineStart ? spacing * (item - lineStart) : 0);
+			
+			if (!justified && item > lineStart && lineWidth + itemWidth > availableWidth)
+				break;
+			
+			itemsWidth += itemWidth;
+			item++;
+			
+			if (justified && lineWidth + itemWidth >= availableWidth)
+				break;
+		}
+		
+		CGFloat totalSpacing = spacing * (item - lineStart - 1);
+		CGFloat scale = 1;
+		if (justified && itemsWidth > 0 && itemsWidth + totalSpacing >= availableWidth) {
+			scale = MAX(0, availableWidth - totalSpacing) / itemsWidth;
+		}
+		
+		CGFloat x = insets.left;
+		CGFloat lineHeight = 0;
+		for (NSInteger lineItem = lineStart; lineItem < item; lineItem++) {
+			CGSize size = section.itemSizes[lineItem];
+			CGRect frame = CGRectMake(x, y, size.width * scale, size.height * scale);
+			section.itemFrames[lineItem] = frame;
+			x += frame.size.width + spacing;
+			lineHeight = MAX(lineHeight, frame.size.height);
+		}
+		
+		section.lineStarts[line] = lineStart;
+		section.lineOffsets[line] = y;
+		section.lineHeights[line] = lineHeight;
+		line++;
+		
+		y += lineHeight + self.lineSpacing;
+	}
+	
+	section.numberOfLines = line;
+}
+
+- (JNWCollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
+	JNWCollectionViewFlowLayoutSection *section = self.sections[indexPath.jnw_section];
+	
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = CGRectOffset(section.itemFrames[indexPath.jnw_item], 0, section.offset);
+	attributes.alpha = 1.f;
+	return attributes;
+}
+
+- (JNWCollectionViewLayoutAttributes *)layoutAttributesForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = [self rectForSupplementaryItemInSection:sectionIdx kind:kind];
+	attributes.alpha = 1.f;
+	attributes.zIndex = NSIntegerMax;
+	return attributes;
+}
+
+- (CGRect)rectForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
+	JNWCollectionViewFlowLayoutSection *section = self.sections[sectionIdx];
+	CGFloat width = self.collectionView.visibleSize.width;
+	
+	if ([kind isEqualToString:JNWCollectionViewFlowLayoutHeaderKind]) {
+		return CGRectMake(0, section.offset, width, section.headerHeight);
+	} else if ([kind isEqualToString:JNWCollectionViewFlowLayoutFooterKind]) {
+		return CGRectMake(0, section.offset + section.height - section.footerHeight, width, section.footerHeight);
+	}
+	
+	return CGRectZero;
+}
+
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	NSMutableDictionary *indexesByKind = [NSMutableDictionary dictionary];
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSString *kind in kinds) {
+		if (![kind isEqualToString:JNWCollectionViewFlowLayoutHeaderKind] && ![kind isEqualToString:JNWCollectionViewFlowLayoutFooterKind])
+			continue;
+		
+		NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+		for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+			JNWCollectionViewFlowLayoutSection *section = self.sections[sectionIdx];
+			if (section.offset >= CGRectGetMaxY(rect))
+				break;
+			
+			if (CGRectIntersectsRect([self rectForSupplementaryItemInSection:sectionIdx kind:kind], rect)) {
+				[indexes addIndex:sectionIdx];
+			}
+		}
+		
+		if (indexes.count > 0) {
+			indexesByKind[kind] = indexes;
+		}
+	}
+	
+	return indexesByKind;
+}
+
+- (BOOL)shouldApplyExistingLayoutAttributesOnLayout {
+	return NO;
+}
+
+- (CGRect)rectForSectionAtIndex:(NSInteger)index {
+	JNWCollectionViewFlowLayoutSection *section = self.sections[index];
+	return CGRectMake(0, section.offset, self.collectionView.visibleSize.width, section.height);
+}
+
+- (NSArray *)indexPathsForItemsInRect:(CGRect)rect {
+	NSMutableArray *indexPaths = [NSMutableArray array];
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+		JNWCollectionViewFlowLayoutSection *section = self.sections[sectionIdx];
+		if (section.offset >= CGRectGetMaxY(rect))
+			break;
+		
+		CGRect relativeRect = CGRectOffset(rect, 0, -section.offset);
+		
+		for (NSInteger line = [section lineEndingBelowOffset:CGRectGetMinY(relativeRect)]; line < section.numberOfLines; line++) {
+			if (section.lineOffsets[line] >= CGRectGetMaxY(relativeRect))
+				break;
+			
+			NSInteger lineEnd = [section endOfLine:line];
+			for (NSInteger item = section.lineStarts[line]; item < lineEnd; item++) {
+				if (CGRectIntersectsRect(section.itemFrames[item], relativeRect)) {
+					[indexPaths addObject:[NSIndexPath jnw_indexPathForItem:item inSection:sectionIdx]];
+				}
+			}
+		}
+	}
+	
+	return indexPaths;
+}
+
+- (NSIndexPath *)indexPathForNextItemInDirection:(JNWCollectionViewDirection)direction currentIndexPath:(NSIndexPath *)currentIndexPath {
+	if (direction == JNWCollectionViewDirectionLeft) {
+		return [self.collectionView indexPathForNextSelectableItemBeforeIndexPath:currentIndexPath];
+	} else if (direction == JNWCollectionViewDirectionRight) {
+		return [self.collectionView indexPathForNextSelectableItemAfterIndexPath:currentIndexPath];
+	}
+	
+	if (currentIndexPath == nil || currentIndexPath.jnw_section >= self.sections.count)
+		return currentIndexPath;
+	
+	JNWCollectionViewFlowLayoutSection *section = self.sections[currentIndexPath.jnw_section];
+	if (currentIndexPath.jnw_item >= section.numberOfItems)
+		return currentIndexPath;
+	
+	// Moving vertically picks the item in the adjacent line closest to the horizontal center of the current item.
+	NSInteger line = [section lineForItem:currentIndexPath.jnw_item] + (direction == JNWCollectionViewDirectionUp ? -1 : 1);
+	if (line < 0) {
+		return [self.collectionView indexPathForNextSelectableItemBeforeIndexPath:[NSIndexPath jnw_indexPathForItem:0 inSection:section.index]];
+	} else if (line >= section.numberOfLines) {
+		return [self.collectionView indexPathForNextSelectableItemAfterIndexPath:[NSIndexPath jnw_indexPathForItem:section.numberOfItems - 1 inSection:section.index]];
+	}
+	
+	CGFloat midX = CGRectGetMidX(section.itemFrames[currentIndexPath.jnw_item]);
+	NSInteger lineEnd = [section endOfLine:line];
+	NSInteger item = section.lineStarts[line];
+	while (item + 1 < lineEnd && CGRectGetMaxX(section.itemFrames[item]) < midX) {
+		item++;
+	}
+	
+	return [NSIndexPath jnw_indexPathForItem:item inSection:section.index];
+}
+
+/// Returns the index of the last section starting at or above the offset, or NSNotFound
+/// if the offset is above the first section.
+- (NSInteger)sectionIndexAtOffset:(CGFloat)offset {
+	NSInteger low = 0;
+	NSInteger high = self.sections.count - 1;
+	NSInteger result = NSNotFound;
+	
+	while (low <= high) {
+		NSInteger mid = (low + high) / 2;
+		JNWCollectionViewFlowLayoutSection *section = self.sections[mid];
+		
+		if (section.offset <= offset) {
+			result = mid;
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	
+	return result;
+}
+
+@end
@@ -21,6 +21,7 @@
 #import <Cocoa/Cocoa.h>
 #import "JNWCollectionViewCell.h"
 #import "JNWCollectionViewReusableView.h"
+#import "JNWCollectionViewReusePool.h"
 #import "NSIndexPath+JNWAdditions.h"
 #if defined(COCOAPODS)
 #import <JNWScrollView/JNWScrollView.h>
@@ -78,6 +79,23 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// -registerClass:forSupplementaryViewOfKind:withReuseIdentifier:.
 - (JNWCollectionViewReusableView *)collectionView:(JNWCollectionView *)collectionView viewForSupplementaryViewOfKind:(NSString *)kind inSection:(NSInteger)section;
 
+/// Asks the data source for the string used to find the item when the user types the first characters of it,
+/// like type-select in NSTableView. Typing jumps the selection to the first item in alphabetical order whose
+/// string begins with the typed characters, ignoring case and diacritics.
+///
+/// If this method is not implemented, type-select is disabled. The strings are collected into an index the first
+/// time they are needed, on a background thread, so this method must be safe to call from any thread and must not
+/// access any views. The index is updated for inserted and deleted items, and rebuilt after the data is reloaded.
+- (NSString *)collectionView:(JNWCollectionView *)collectionView typeSelectStringForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+/// Asks the data source for a cheaper variant of the cell at the specified index path, used while scrolling
+/// faster than `highVelocityScrollThreshold` for items that have no snapshot yet. The cell is replaced with
+/// the one from -collectionView:cellForItemAtIndexPath: once scrolling slows down, so lightweight cells should
+/// be registered under a reuse identifier of their own.
+///
+/// If this method is not implemented or returns nil, the full cell is used.
+- (JNWCollectionViewCell *)collectionView:(JNWCollectionView *)collectionView lightweightCellForItemAtIndexPath:(NSIndexPath *)indexPath;
+
 @end
 
 #pragma mark Delegate Protocol
@@ -141,7 +159,8 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// Asks the delegate if the item at the specified index path should be scrolled to.
 - (BOOL)collectionView:(JNWCollectionView *)collectionView shouldScrollToItemAtIndexPath:(NSIndexPath *)indexPath;
 
-/// Tells the delegate that the specified index path has been scrolled to.
+/// Tells the delegate that the specified index path has been scrolled to. For an animated scroll, this is
+/// called once the animation has finished.
 - (void)collectionView:(JNWCollectionView *)collectionView didScrollToItemAtIndexPath:(NSIndexPath *)indexPath;
 
 /// Tells the delegate that the cell for the specified index path has been put
@@ -155,6 +174,11 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// The objectValue object is used for data binding. 
 - (id)collectionView:(JNWCollectionView *)collectionView objectValueForItemAtIndexPath:(NSIndexPath *)indexPath;
 
+/// Tells the delegate that a layout pass spent longer creating cells than `cellCreationBudget` allows,
+/// along with the number of cells that were deferred to later frames as a result. This is intended for
+/// tuning the budget.
+- (void)collectionView:(JNWCollectionView *)collectionView didExceedCellCreationBudgetWithDuration:(NSTimeInterval)duration numberOfDeferredCells:(NSUInteger)numberOfDeferredCells;
+
 @end
 
 #pragma mark Drag and Drop Delegate Protocol
@@ -213,6 +237,53 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// view has been completed.
 - (void)reloadData;
 
+/// If set to YES, -reloadData keeps the visible cells and supplementary views instead of discarding them.
+/// They are moved into the reuse queues, and the data source is asked to configure them for the new data.
+/// A cell dequeued for an index path it was already displaying before the reload is handed back to that
+/// same index path when the reuse identifier matches, so unchanged items only have their content updated.
+///
+/// This avoids rebuilding the view hierarchy on every reload, which helps when the model is refreshed often.
+///
+/// Defaults to NO.
+@property (nonatomic, assign) BOOL recyclesViewsOnReload;
+
+/// The time, in seconds, that a layout pass may spend creating and configuring the cells which have
+/// become visible. Once it has been used up, the remaining cells are shown as placeholders and created
+/// on the following frames, starting with those closest to the middle of the visible area.
+///
+/// This keeps fast scrolling smooth when cells are expensive to configure, at the cost of briefly
+/// showing placeholders.
+///
+/// Defaults to 0, which creates all cells immediately.
+@property (nonatomic, assign) NSTimeInterval cellCreationBudget;
+
+/// The color of the placeholders shown for cells deferred by `cellCreationBudget`.
+///
+/// Defaults to a light gray.
+@property (nonatomic, strong) NSColor *cellPlaceholderColor;
+
+/// The scroll velocity, in points per second, above which cells are no longer created at full fidelity.
+/// Instead, items are drawn from snapshots of their cells taken the last time they scrolled out of view
+/// at a normal speed, or from the lighter cells supplied by the data source through
+/// -collectionView:lightweightCellForItemAtIndexPath:. Full cells are restored once scrolling slows down.
+///
+/// Snapshots are discarded when their items are reloaded or deleted, when the data is reloaded, and when
+/// the delegate returns a different object value for their items. Inserting or deleting items moves the
+/// snapshots of the following items along with them. Items whose content changes in place, without a
+/// new object value, need to be reloaded with -reloadItemsAtIndexPaths: for their snapshots to be retaken.
+///
+/// Defaults to 0, which disables high velocity scrolling and snapshots altogether.
+@property (nonatomic, assign) CGFloat highVelocityScrollThreshold;
+
+/// Whether the collection view is currently scrolling faster than `highVelocityScrollThreshold`.
+@property (nonatomic, assign, readonly, getter = isScrollingAtHighVelocity) BOOL scrollingAtHighVelocity;
+
+/// The maximum total size, in bytes, of the cell snapshots kept for high velocity scrolling. The least
+/// recently used snapshots are discarded once the limit is exceeded.
+///
+/// Defaults to 32MB.
+@property (nonatomic, assign) NSUInteger snapshotCacheSizeLimit;
+
 /// In order for cell or supplementary view dequeueing to occur, a class must be registered with the appropriate
 /// registration method.
 ///
@@ -245,6 +316,15 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 - (JNWCollectionViewCell *)dequeueReusableCellWithIdentifier:(NSString *)identifier;
 - (JNWCollectionViewReusableView *)dequeueReusableSupplementaryViewOfKind:(NSString *)kind withReuseIdentifer:(NSString *)identifier;
 
+/// The pool that cells and supplementary views are put into when they are no longer visible, and are
+/// dequeued from. Several collection views can share a pool, so that views are reused across them.
+///
+/// Views waiting in the previous pool are discarded if it isn't shared. A shared pool is not emptied
+/// when the data is reloaded; use -[JNWCollectionViewReusePool removeAllViews] for that.
+///
+/// Defaults to a pool of the collection view's own. Setting this to nil restores such a pool.
+@property (nonatomic, strong) JNWCollectionViewReusePool *reusePool;
+
 /// The layout is responsible for providing the positioning and layout attributes for cells and views.
 /// It is also responsible for handling selection changes that are performed via the keyboard. See the
 /// documentation in JNWCollectionViewLayout.h.
@@ -333,6 +413,50 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// Returns the index paths for any selected items. Order is not guaranteed.
 - (NSArray *)indexPathsForSelectedItems;
 
+#pragma mark - Statistics
+
+/// The number of times layout attributes were applied to a cell, and the number of times applying them
+/// was skipped because they were identical to the attributes the cell already had.
+///
+/// These counters are cumulative and are intended for measuring the cost of layout passes.
+@property (nonatomic, assign, readonly) NSUInteger numberOfAppliedCellLayoutUpdates;
+@property (nonatomic, assign, readonly) NSUInteger numberOfSkippedCellLayoutUpdates;
+
+/// The number of cells and supplementary views that had to be created because none could be dequeued
+/// from the reuse queues, and the number of times the data was reloaded.
+@property (nonatomic, assign, readonly) NSUInteger numberOfCreatedCells;
+@property (nonatomic, assign, readonly) NSUInteger numberOfCreatedSupplementaryViews;
+@property (nonatomic, assign, readonly) NSUInteger numberOfReloads;
+
+/// The number of times a cell was shown as a placeholder because the cell creation budget had run out,
+/// and the number of layout passes which took longer than the budget.
+@property (nonatomic, assign, readonly) NSUInteger numberOfDeferredCells;
+@property (nonatomic, assign, readonly) NSUInteger numberOfCellCreationBudgetOverruns;
+
+/// The number of times an item was shown from a snapshot, and the number of lightweight cells added,
+/// while scrolling at high velocity.
+@property (nonatomic, assign, readonly) NSUInteger numberOfSnapshotCells;
+@property (nonatomic, assign, readonly) NSUInteger numberOfLightweightCells;
+
+/// Resets all of the statistics counters to zero.
+- (void)resetStatistics;
+
+#pragma mark - Hover Tracking
+
+/// If set to YES, cells will not install their own tracking areas. Instead, a single tracking area on the
+/// collection view drives the mouse entered, exited and moved delegate callbacks and the hovered state
+/// of cells, by hit-testing the mouse location against the layout.
+///
+/// This avoids creating and rebuilding a tracking area for every visible cell while scrolling, which can
+/// be expensive when thousands of cells are visible.
+///
+/// Defaults to NO.
+@property (nonatomic, assign) BOOL usesSingleTrackingArea;
+
+/// The index path of the item the mouse is currently over when usesSingleTrackingArea is enabled,
+/// otherwise nil.
+@property (nonatomic, strong, readonly) NSIndexPath *indexPathForHoveredItem;
+
 #pragma mark - Selection
 
 /// If set to YES, any changes to the backgroundImage or backgroundColor properties of the collection view cell
@@ -363,11 +487,24 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollPosition) {
 /// Defaults to YES.
 @property (nonatomic, assign) BOOL allowsSelectAll;
 
+/// If set to YES, dragging from an area outside of the items draws a marquee, selecting the items it
+/// covers. Holding shift adds the items to the selection, and holding command toggles them. The
+/// collection view auto-scrolls while dragging if the layout's `shouldAutoScroll` is enabled.
+///
+/// The marquee only queries the layout for the areas swept between mouse events, so dragging it across
+/// a large number of items does not enumerate items outside of it. Requires allowsMultipleSelection.
+///
+/// Defaults to NO.
+@property (nonatomic, assign) BOOL allowsMarqueeSelection;
+
 /// Returns the list of indexPaths of the selected items
 @property (nonatomic, readonly) NSMutableArray *selectedIndexes;
 
 /// Scrolls the collection view to the item at the specified path, optionally animated. The scroll position determines
-/// where the item is positioned on the screen.
+/// where the item is positioned on the screen, along the scroll direction of the layout.
+///
+/// Animated scrolls over long distances jump close to the item first and only animate the last part, so cells
+/// are not created for all of the items in between.
 - (void)scrollToItemAtIndexPath:(NSIndexPath *)indexPath atScrollPosition:(JNWCollectionViewScrollPosition)scrollPosition animated:(BOOL)animated;
 
 /// Selects the item at the specified index path, deselecting any other selected items in the process, optionally animated.
@@ -26,6 +26,9 @@
 #import "JNWCollectionViewData.h"
 #import "JNWCollectionViewListLayout.h"
 #import "JNWCollectionViewDocumentView.h"
+#import "JNWCollectionViewTypeSelectIndex.h"
+#import "JNWCollectionViewSnapshotCache.h"
+#import "JNWCollectionViewReusePool+Private.h"
 #import "JNWCollectionViewLayout.h"
 #import "JNWCollectionViewLayout+Private.h"
 
@@ -48,6 +51,8 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewSelectionType) {
 	struct {
 		unsigned int dataSourceNumberOfSections:1;
 		unsigned int dataSourceViewForSupplementaryView:1;
+		unsigned int dataSourceTypeSelectString:1;
+		unsigned int dataSourceLightweightCell:1;
 		
 		unsigned int delegateMouseDown:1;
 		unsigned int delegateMouseDownWithEvent:1;
@@ -71,6 +76,7 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewSelectionType) {
 		unsigned int delegateDidEndDisplayingCell:1;
 		unsigned int delegateMenuForEvent:1;
 		unsigned int delegateObjectValueForCell:1;
+		unsigned int delegateDidExceedCellCreationBudget:1;
 		
 		unsigned int dragDropDelegateAllowsDragDrop:1;
 		unsigned int dragDropDelegateDropMarker:1;
@@ -80,6 +86,12 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewSelectionType) {
 	} _collectionViewFlags;
 	
 	CGSize _lastDrawnSize;
+	CFTimeInterval _lastLiveResizeLayoutTime;
+	CGRect _lastDropMarkerFrame;
+	
+	CFTimeInterval _lastScrollTime;
+	CGPoint _lastScrollOrigin;
+	CGFloat _scrollVelocity;
 }
 
 // Layout data/cache
@@ -90,21 +102,63 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewSelectionType) {
 @property (nonatomic) NSArray *selectedIndexesDiff;
 
 // Cells
-@property (nonatomic, strong) NSMutableDictionary *reusableCells; // { identifier : (cells) }
+@property (nonatomic, assign) BOOL ownsReusePool;
 @property (nonatomic, strong) NSMutableDictionary *visibleCellsMap; // { index path : cell }
 @property (nonatomic, strong) NSMutableDictionary *cellClassMap; // { identifier : class }
 @property (nonatomic, strong) NSMutableDictionary *cellNibMap; // { identifier : nib }
+@property (nonatomic, strong) NSMutableDictionary *recycledCellsMap; // { index path : cell }, only during a recycling reload
+@property (nonatomic, strong) NSIndexPath *indexPathForCellBeingAdded;
+@property (nonatomic, strong) NSMutableDictionary *cellPlaceholders; // { index path : view }, for cells deferred by the budget
+@property (nonatomic, strong) NSMutableArray *reusableCellPlaceholders;
+
+// High velocity scrolling
+@property (nonatomic, assign, readwrite, getter = isScrollingAtHighVelocity) BOOL scrollingAtHighVelocity;
+@property (nonatomic, strong) JNWCollectionViewSnapshotCache *snapshotCache;
+@property (nonatomic, strong) NSMutableSet *lightweightCellIndexPaths;
+
+// Type select
+@property (nonatomic, strong) JNWCollectionViewTypeSelectIndex *typeSelectIndex;
+@property (nonatomic, strong) NSMutableString *typeSelectString;
+@property (nonatomic, assign) NSTimeInterval lastTypeSelectTimestamp;
 
 // Supplementary views
-@property (nonatomic, strong) NSMutableDictionary *reusableSupplementaryViews; // { "kind/identifier" : (views) }
 @property (nonatomic, strong) NSMutableDictionary *visibleSupplementaryViewsMap; // { "index/kind/identifier" : view } }
 @property (nonatomic, strong) NSMutableDictionary *supplementaryViewClassMap; // { "kind/identifier" : class }
 @property (nonatomic, strong) NSMutableDictionary *supplementaryViewNibMap; // { "kind/identifier" : nib }
 
 @property (nonatomic, strong) NSView *collectionViewDocumentView;
 
+// Scrolling
+@property (nonatomic, strong) NSIndexPath *indexPathForAnimatedScroll;
+@property (nonatomic, assign) CGPoint destinationOfAnimatedScroll;
+
+// Hover tracking
+@property (nonatomic, strong) NSTrackingArea *hoverTrackingArea;
+@property (nonatomic, strong, readwrite) NSIndexPath *indexPathForHoveredItem;
+
+// Marquee selection
+@property (nonatomic, strong) NSView *marqueeView;
+@property (nonatomic, assign) CGPoint marqueeOrigin;
+@property (nonatomic, assign) CGRect marqueeRect;
+@property (nonatomic, assign) BOOL marqueeTogglesSelection;
+@property (nonatomic, strong) NSSet *marqueeInitialSelection;
+@property (nonatomic, strong) NSMutableSet *marqueeSelection; // mirrors selectedIndexes while the marquee is active
+@property (nonatomic, strong) NSMutableDictionary *marqueeCoveredIndexes; // { section : item indexes }
+
 // Drag and drop
 @property (nonatomic, strong) NSView *dropMarker;
+@property (nonatomic, strong) JNWCollectionViewDropIndexPath *dropMarkerDropPath; // the drop path the marker was created for
+
+// Statistics
+@property (nonatomic, assign, readwrite) NSUInteger numberOfAppliedCellLayoutUpdates;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfSkippedCellLayoutUpdates;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfCreatedCells;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfCreatedSupplementaryViews;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfReloads;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfDeferredCells;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfCellCreationBudgetOverruns;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfSnapshotCells;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfLightweightCells;
 
 // Insert & Delete
 @property BOOL willBeginBatchUpdates;
@@ -128,11 +182,16 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	collectionView.cellClassMap = [NSMutableDictionary dictionary];
 	collectionView.cellNibMap = [NSMutableDictionary dictionary];
 	collectionView.visibleCellsMap = [NSMutableDictionary dictionary];
-	collectionView.reusableCells = [NSMutableDictionary dictionary];
+	collectionView.reusePool = nil;
 	collectionView.supplementaryViewClassMap = [NSMutableDictionary dictionary];
 	collectionView.supplementaryViewNibMap = [NSMutableDictionary dictionary];
 	collectionView.visibleSupplementaryViewsMap = [NSMutableDictionary dictionary];
-	collectionView.reusableSupplementaryViews = [NSMutableDictionary dictionary];
+	collectionView.cellPlaceholders = [NSMutableDictionary dictionary];
+	collectionView.reusableCellPlaceholders = [NSMutableArray array];
+	collectionView.cellPlaceholderColor = [NSColor colorWithCalibratedWhite:0.9 alpha:1];
+	collectionView.snapshotCache = [[JNWCollectionViewSnapshotCache alloc] init];
+	collectionView.snapshotCacheSizeLimit = 32 * 1024 * 1024;
+	collectionView.lightweightCellIndexPaths = [NSMutableSet set];
 	
 	// By default we are layer-backed.
 	collectionView.wantsLayer = YES;
@@ -205,12 +264,16 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	_collectionViewFlags.delegateDidScroll = [delegate respondsToSelector:@selector(collectionView:didScrollToItemAtIndexPath:)];
 	_collectionViewFlags.delegateMenuForEvent = [delegate respondsToSelector:@selector(collectionView:menuForEvent:)];
 	_collectionViewFlags.delegateObjectValueForCell = [delegate respondsToSelector:@selector(collectionView:objectValueForItemAtIndexPath:)];
+	_collectionViewFlags.delegateDidExceedCellCreationBudget = [delegate respondsToSelector:@selector(collectionView:didExceedCellCreationBudgetWithDuration:numberOfDeferredCells:)];
 }
 
 - (void)setDataSource:(id<JNWCollectionViewDataSource>)dataSource {
 	_dataSource = dataSource;
 	_collectionViewFlags.dataSourceNumberOfSections = [dataSource respondsToSelector:@selector(numberOfSectionsInCollectionView:)];
 	_collectionViewFlags.dataSourceViewForSupplementaryView = [dataSource respondsToSelector:@selector(collectionView:viewForSupplementaryViewOfKind:inSection:)];
+	_collectionViewFlags.dataSourceTypeSelectString = [dataSource respondsToSelector:@selector(collectionView:typeSelectStringForItemAtIndexPath:)];
+	_collectionViewFlags.dataSourceLightweightCell = [dataSource respondsToSelector:@selector(collectionView:lightweightCellForItemAtIndexPath:)];
+	[self.typeSelectIndex invalidate];
 	NSAssert(dataSource == nil || [dataSource respondsToSelector:@selector(collectionView:numberOfItemsInSection:)],
 			 @"data source must implement collectionView:numberOfItemsInSection");
 	NSAssert(dataSource == nil || [dataSource respondsToSelector:@selector(collectionView:cellForItemAtIndexPath:)],
@@ -271,34 +334,17 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[self.supplementaryViewClassMap removeObjectForKey:identifier];
 }
 
-- (id)dequeueItemWithIdentifier:(NSString *)identifier inReusePool:(NSDictionary *)reuse {
-	if (identifier == nil)
-		return nil;
-	
-	NSMutableArray *reusableItems = reuse[identifier];
-	if (reusableItems != nil) {
-		id reusableItem = [reusableItems lastObject];
-		
-		if (reusableItem != nil) {
-			[reusableItems removeObject:reusableItem];
-			return reusableItem;
-		}
-	}
-	
-	return nil;
-}
-
-- (void)enqueueItem:(id)item withIdentifier:(NSString *)identifier inReusePool:(NSMutableDictionary *)reuse {
-	if (identifier == nil)
+- (void)setReusePool:(JNWCollectionViewReusePool *)reusePool {
+	if (_reusePool == reusePool && reusePool != nil)
 		return;
 	
-	NSMutableArray *reusableCells = reuse[identifier];
-	if (reusableCells == nil) {
-		reusableCells = [NSMutableArray array];
-		reuse[identifier] = reusableCells;
+	// Nothing else can be holding on to the views in a pool of our own.
+	if (self.ownsReusePool) {
+		[_reusePool removeAllViews];
 	}
 	
-	[reusableCells addObject:item];
+	self.ownsReusePool = (reusePool == nil);
+	_reusePool = reusePool ?: [[JNWCollectionViewReusePool alloc] init];
 }
 
 - (id)firstTopLevelObjectOfClass:(Class)objectClass inNib:(NSNib *)nib {
@@ -325,11 +371,21 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 
 - (JNWCollectionViewCell *)dequeueReusableCellWithIdentifier:(NSString *)identifier {
 	NSParameterAssert(identifier);
-	JNWCollectionViewCell *cell = [self dequeueItemWithIdentifier:identifier inReusePool:self.reusableCells];
+	JNWCollectionViewCell *cell = [self dequeueRecycledCellWithIdentifier:identifier];
+	if (cell == nil) {
+		cell = [self.reusePool dequeueCellWithIdentifier:identifier];
+		
+		// A recycled cell taken for another index path can't be handed out again for its own.
+		if (cell != nil && self.recycledCellsMap[cell.indexPath] == cell) {
+			[self.recycledCellsMap removeObjectForKey:cell.indexPath];
+		}
+	}
 	
 	// If the view doesn't exist, we go ahead and create one. If we have a class registered
 	// for this identifier, we use it, otherwise we just create an instance of JNWCollectionViewCell.
 	if (cell == nil) {
+		self.numberOfCreatedCells++;
+		
 		Class cellClass = self.cellClassMap[identifier];
 		NSNib *cellNib = self.cellNibMap[identifier];
 		
@@ -365,9 +421,11 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	NSParameterAssert(kind);
 	
 	NSString *identifier = [self supplementaryViewIdentifierWithKind:kind reuseIdentifier:reuseIdentifier];
-	JNWCollectionViewReusableView *view = [self dequeueItemWithIdentifier:identifier inReusePool:self.reusableSupplementaryViews];
+	JNWCollectionViewReusableView *view = [self.reusePool dequeueSupplementaryViewWithIdentifier:identifier];
 	
 	if (view == nil) {
+		self.numberOfCreatedSupplementaryViews++;
+		
 		Class viewClass = self.supplementaryViewClassMap[identifier];
 		NSNib *viewNib = self.supplementaryViewNibMap[identifier];
 		
@@ -388,19 +446,47 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	return view;
 }
 
+// During a recycling reload, returns the cell that displayed the index path being added before the
+// reload, provided it has the same identifier and is still in the reuse queue, taking it out of it.
+// With a shared reuse pool, another collection view may have dequeued the cell in the meantime.
+- (JNWCollectionViewCell *)dequeueRecycledCellWithIdentifier:(NSString *)identifier {
+	NSIndexPath *indexPath = self.indexPathForCellBeingAdded;
+	if (self.recycledCellsMap == nil || indexPath == nil)
+		return nil;
+	
+	JNWCollectionViewCell *cell = self.recycledCellsMap[indexPath];
+	if (cell == nil || ![cell.reuseIdentifier isEqualToString:identifier])
+		return nil;
+	
+	[self.recycledCellsMap removeObjectForKey:indexPath];
+	if (![self.reusePool removeCell:cell withIdentifier:identifier])
+		return nil;
+	
+	return cell;
+}
+
 - (void)enqueueReusableCell:(JNWCollectionViewCell *)cell withIdentifier:(NSString *)identifier {
-	[self enqueueItem:cell withIdentifier:identifier inReusePool:self.reusableCells];
+	// The cell's geometry can't be trusted once it leaves the visible set, so make sure it
+	// gets a full layout update when it's dequeued again.
+	cell.appliedLayoutAttributes = nil;
+	if (![self.reusePool enqueueCell:cell withIdentifier:identifier]) {
+		[cell removeFromSuperview];
+	}
 }
 
 - (void)enqueueReusableSupplementaryView:(JNWCollectionViewReusableView *)view ofKind:(NSString *)kind withReuseIdentifier:(NSString *)reuseIdentifier {
 	NSString *identifier = [self supplementaryViewIdentifierWithKind:kind reuseIdentifier:reuseIdentifier];
-	[self enqueueItem:view withIdentifier:identifier inReusePool:self.reusableSupplementaryViews];
+	if (![self.reusePool enqueueSupplementaryView:view withIdentifier:identifier reuseIdentifier:reuseIdentifier]) {
+		[view removeFromSuperview];
+	}
 }
 
 #pragma mark Reloading
 
 - (void)reloadData {
 	_collectionViewFlags.wantsLayout = YES;
+	[self.typeSelectIndex invalidate];
+	[self.snapshotCache removeAllSnapshots];
 	
 	// Remove and notify any selected indexes we've been tracking.
 	NSArray *selectedIndexes = self.selectedIndexes.copy;
@@ -415,8 +501,17 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
         [self.delegate collectionView:self didDeselectItemsAtIndexPaths:[NSSet setWithArray:self.selectedIndexes]];
     }
 	
-	[self.data recalculateAndPrepareLayout:YES];
-	[self performFullRelayoutForcingSubviewsReset:YES];
+	self.numberOfReloads++;
+	
+	if (self.recyclesViewsOnReload) {
+		[self recycleAllCellsAndSupplementaryViews];
+		[self.data recalculateAndPrepareLayout:YES];
+		[self performFullRelayoutForcingSubviewsReset:NO];
+		self.recycledCellsMap = nil;
+	} else {
+		[self.data recalculateAndPrepareLayout:YES];
+		[self performFullRelayoutForcingSubviewsReset:YES];
+	}
 	
 	// Select the first item if empty selection is not allowed
 	if (!self.allowsEmptySelection) {
@@ -450,9 +545,10 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 
 /// Completely removes and resets cells, supplementary views, and selection state.
 - (void)resetAllCellsAndSupplementaryViews {
-	// Remove any queued views.
-	[self.reusableCells removeAllObjects];
-	[self.reusableSupplementaryViews removeAllObjects];
+	// Remove any queued views, unless other collection views are sharing them.
+	if (self.ownsReusePool) {
+		[self.reusePool removeAllViews];
+	}
 	
 	// Remove any view mappings
 	if (_collectionViewFlags.delegateDidEndDisplayingCell) {
@@ -462,6 +558,9 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	}
 	[self.visibleCellsMap removeAllObjects];
 	[self.visibleSupplementaryViewsMap removeAllObjects];
+	[self.cellPlaceholders removeAllObjects];
+	[self.reusableCellPlaceholders removeAllObjects];
+	[self.lightweightCellIndexPaths removeAllObjects];
 	
 	// Remove any cells or views that might be added to the document view.
 	NSArray *subviews = [[self.documentView subviews] copy];
@@ -471,6 +570,20 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	}
 }
 
+- (void)recycleAllCellsAndSupplementaryViews {
+	// The cells and supplementary views stay in the document view, hidden, while they are in the reuse queue.
+	self.recycledCellsMap = [self.visibleCellsMap mutableCopy];
+	for (NSIndexPath *indexPath in self.visibleCellsMap.allKeys) {
+		[self removeAndEnqueueCellAtIndexPath:indexPath];
+	}
+	
+	[self.visibleSupplementaryViewsMap enumerateKeysAndObjectsUsingBlock:^(NSString *layoutIdentifier, JNWCollectionViewReusableView *view, BOOL *stop) {
+		[view setHidden:YES];
+		[self enqueueReusableSupplementaryView:view ofKind:view.kind withReuseIdentifier:view.reuseIdentifier];
+	}];
+	[self.visibleSupplementaryViewsMap removeAllObjects];
+}
+
 #pragma mark Cell Information
 
 - (NSInteger)numberOfSections {
@@ -482,7 +595,19 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 }
 
 - (NSIndexPath *)indexPathForItemAtPoint:(CGPoint)point {
-	// TODO: Optimize, and perhaps have an option to defer this to the layout class.
+	// If the layout can answer rect queries, only the handful of items around the point need to be checked.
+	NSArray *potentialIndexPaths = [self.collectionViewLayout indexPathsForItemsInRect:CGRectMake(point.x, point.y, 1, 1)];
+	if (potentialIndexPaths != nil) {
+		for (NSIndexPath *indexPath in potentialIndexPaths) {
+			JNWCollectionViewLayoutAttributes *attributes = [self.collectionViewLayout layoutAttributesForItemAtIndexPath:indexPath];
+			if (CGRectContainsPoint(attributes.frame, point)) {
+				return indexPath;
+			}
+		}
+		
+		return nil;
+	}
+	
 	for (int i = 0; i < self.data.numberOfSections; i++) {
 		JNWCollectionViewSection section = self.data.sections[i];
 		if (!CGRectContainsPoint(section.frame, point))
@@ -579,6 +704,28 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	if (CGRectEqualToRect(rect, CGRectZero))
 		return visibleIdentifiers;
 	
+	NSMutableArray *kinds = [NSMutableArray array];
+	for (NSString *identifier in allIdentifiers) {
+		NSString *kind = [self kindForSupplementaryViewIdentifier:identifier];
+		if (![kinds containsObject:kind])
+			[kinds addObject:kind];
+	}
+	
+	// If the layout supports the batched query, only the sections it returns need to be considered.
+	NSDictionary *sectionsByKind = [self.collectionViewLayout indexesForSupplementaryItemsOfKinds:kinds inRect:rect];
+	if (sectionsByKind != nil) {
+		for (NSString *identifier in allIdentifiers) {
+			NSIndexSet *sections = sectionsByKind[[self kindForSupplementaryViewIdentifier:identifier]];
+			[sections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+				if (section < self.data.numberOfSections) {
+					[visibleIdentifiers addObject:[self layoutIdentifierForSupplementaryViewIdentifier:identifier inSection:section]];
+				}
+			}];
+		}
+		
+		return visibleIdentifiers.copy;
+	}
+	
 	for (int i = 0; i < self.data.numberOfSections; i++) {
 		JNWCollectionViewSection section = self.data.sections[i];
 		for (NSString *identifier in allIdentifiers) {
@@ -613,44 +760,120 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	return [self indexPathsForItemsInRect:self.documentVisibleRect];
 }
 
-- (void)scrollToItemAtIndexPath:(NSIndexPath *)indexPath atScrollPosition:(JNWCollectionViewScrollPosition)scrollPosition animated:(BOOL)animated {
-	if (_collectionViewFlags.delegateShouldScroll && ![self.delegate collectionView:self shouldScrollToItemAtIndexPath:indexPath]) {
-		return;
-	}
-	
-	CGRect rect = [self rectForItemAtIndexPath:indexPath];
-	CGRect visibleRect = self.documentVisibleRect;
+// Animated scrolls further than this many visible lengths jump most of the way first, so that
+// cells aren't created for every item passed along the way.
+static const CGFloat JNWCollectionViewMaximumAnimatedScrollDistance = 2.f;
+
+// An animated scroll that is interrupted never reaches its destination, so the delegate is told it has
+// finished at the latest after this long.
+static const NSTimeInterval JNWCollectionViewAnimatedScrollTimeout = 1.0;
+
+/// Returns the origin along one axis of the visible rect that places the item at the position.
+static CGFloat JNWCollectionViewScrollOrigin(CGFloat itemMin, CGFloat itemLength, CGFloat visibleMin, CGFloat visibleLength, CGFloat documentLength, JNWCollectionViewScrollPosition scrollPosition) {
+	CGFloat origin = visibleMin;
 	
 	switch (scrollPosition) {
-			break;
 		case JNWCollectionViewScrollPositionTop:
-			// make the top of our rect flush with the top of the visible bounds
-			rect.size.height = CGRectGetHeight(visibleRect);
-			//rect.origin.y = self.documentVisibleRect.origin.y + rect.size.height;
+			origin = itemMin;
 			break;
 		case JNWCollectionViewScrollPositionMiddle:
-			// TODO
-			rect.size.height = self.bounds.size.height;
-			rect.origin.y += (CGRectGetHeight(visibleRect) / 2.f) - CGRectGetHeight(rect);
+			origin = itemMin + (itemLength - visibleLength) / 2.f;
 			break;
 		case JNWCollectionViewScrollPositionBottom:
-			// make the bottom of our rect flush with the bottom of the visible bounds
-			rect.size.height = CGRectGetHeight(visibleRect);
-			rect.origin.y -= CGRectGetHeight(visibleRect);
-			break;
-		case JNWCollectionViewScrollPositionNone:
-			// no scroll needed
-			return;
+			origin = itemMin + itemLength - visibleLength;
 			break;
 		case JNWCollectionViewScrollPositionNearest:
-			// We just pass the cell's frame onto the scroll view. It calculates this for us.
-			break;
-		default: // defaults to the same behavior as nearest
+		default:
+			// Scroll the minimum amount necessary. Items larger than the visible area are aligned to their start.
+			if (itemMin < visibleMin || itemLength > visibleLength) {
+				origin = itemMin;
+			} else if (itemMin + itemLength > visibleMin + visibleLength) {
+				origin = itemMin + itemLength - visibleLength;
+			}
 			break;
 	}
 	
-	[self.clipView scrollRectToVisible:rect animated:animated];
+	return MAX(0, MIN(origin, documentLength - visibleLength));
+}
+
+- (void)scrollToItemAtIndexPath:(NSIndexPath *)indexPath atScrollPosition:(JNWCollectionViewScrollPosition)scrollPosition animated:(BOOL)animated {
+	if (indexPath == nil || scrollPosition == JNWCollectionViewScrollPositionNone) {
+		return;
+	}
+	
+	if (_collectionViewFlags.delegateShouldScroll && ![self.delegate collectionView:self shouldScrollToItemAtIndexPath:indexPath]) {
+		return;
+	}
+	
+	CGRect rect = [self rectForItemAtIndexPath:indexPath];
+	CGRect visibleRect = self.documentVisibleRect;
+	CGSize documentSize = [self.documentView frame].size;
+	
+	// The scroll position applies along the scrolling axis, and the other axis scrolls the minimum amount.
+	JNWCollectionViewScrollDirection direction = self.collectionViewLayout.scrollDirection;
+	JNWCollectionViewScrollPosition horizontalPosition = (direction == JNWCollectionViewScrollDirectionVertical ? JNWCollectionViewScrollPositionNearest : scrollPosition);
+	JNWCollectionViewScrollPosition verticalPosition = (direction == JNWCollectionViewScrollDirectionHorizontal ? JNWCollectionViewScrollPositionNearest : scrollPosition);
+	
+	CGPoint origin = visibleRect.origin;
+	origin.x = JNWCollectionViewScrollOrigin(rect.origin.x, rect.size.width, visibleRect.origin.x, visibleRect.size.width, documentSize.width, horizontalPosition);
+	origin.y = JNWCollectionViewScrollOrigin(rect.origin.y, rect.size.height, visibleRect.origin.y, visibleRect.size.height, documentSize.height, verticalPosition);
+	
+	if (animated) {
+		// Long scrolls jump without animation to within a short distance of the destination, and
+		// only animate the rest of the way.
+		CGPoint start = visibleRect.origin;
+		CGFloat maximumDistanceX = visibleRect.size.width * JNWCollectionViewMaximumAnimatedScrollDistance;
+		CGFloat maximumDistanceY = visibleRect.size.height * JNWCollectionViewMaximumAnimatedScrollDistance;
+		if (ABS(origin.x - start.x) > maximumDistanceX) {
+			start.x = origin.x - copysign(visibleRect.size.width, origin.x - start.x);
+		}
+		if (ABS(origin.y - start.y) > maximumDistanceY) {
+			start.y = origin.y - copysign(visibleRect.size.height, origin.y - start.y);
+		}
+		
+		if (!CGPointEqualToPoint(start, visibleRect.origin)) {
+			[self.clipView scrollToPoint:start];
+			[self reflectScrolledClipView:self.clipView];
+		}
+	}
+	
+	// An animated scroll tells the delegate once the clip view has arrived at the destination.
+	[self finishAnimatedScroll];
+	if (animated && _collectionViewFlags.delegateDidScroll) {
+		self.indexPathForAnimatedScroll = indexPath;
+		self.destinationOfAnimatedScroll = origin;
+		[self performSelector:@selector(finishAnimatedScroll) withObject:nil afterDelay:JNWCollectionViewAnimatedScrollTimeout inModes:@[ NSRunLoopCommonModes ]];
+	}
+	
+	// A rect the size of the visible area can only be made visible by scrolling to its origin.
+	[self.clipView scrollRectToVisible:(CGRect){ .origin = origin, .size = visibleRect.size } animated:animated];
+	
+	if (animated) {
+		[self finishAnimatedScrollIfArrived];
+	} else if (_collectionViewFlags.delegateDidScroll) {
+		[self.delegate collectionView:self didScrollToItemAtIndexPath:indexPath];
+	}
+}
+
+- (void)finishAnimatedScrollIfArrived {
+	if (self.indexPathForAnimatedScroll == nil)
+		return;
 	
+	CGPoint origin = self.documentVisibleRect.origin;
+	CGPoint destination = self.destinationOfAnimatedScroll;
+	if (ABS(origin.x - destination.x) < 1 && ABS(origin.y - destination.y) < 1) {
+		[self finishAnimatedScroll];
+	}
+}
+
+- (void)finishAnimatedScroll {
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(finishAnimatedScroll) object:nil];
+	
+	NSIndexPath *indexPath = self.indexPathForAnimatedScroll;
+	if (indexPath == nil)
+		return;
+	
+	self.indexPathForAnimatedScroll = nil;
 	if (_collectionViewFlags.delegateDidScroll) {
 		[self.delegate collectionView:self didScrollToItemAtIndexPath:indexPath];
 	}
@@ -705,8 +928,13 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[super layout];
 	
 	if (CGSizeEqualToSize(self.visibleSize, _lastDrawnSize)) {
+		[CATransaction begin];
+		[CATransaction setDisableActions:YES];
 		[self layoutCells];
 		[self layoutSupplementaryViews];
+		[CATransaction commit];
+	} else if (self.inLiveResize) {
+		[self layoutForLiveResize];
 	} else {
 		// Calling recalculate on our data will update the bounds needed for the collection
 		// view, and optionally prepare the layout once again if the layout subclass decides
@@ -722,9 +950,62 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	}
 }
 
+#pragma mark Live Resize
+
+// Layout passes during a live resize are limited to the refresh rate of the display.
+static const CFTimeInterval JNWCollectionViewLiveResizeLayoutInterval = 1.0 / 60.0;
+
+- (void)layoutForLiveResize {
+	CFTimeInterval now = CACurrentMediaTime();
+	CFTimeInterval elapsed = now - _lastLiveResizeLayoutTime;
+	if (elapsed < JNWCollectionViewLiveResizeLayoutInterval) {
+		// Coalesce the sizes in between into a single pass once the interval has passed. The run loop is in the
+		// event tracking mode while the window is being resized, so the pass has to be scheduled in it too.
+		[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(setNeedsLayoutForLiveResize) object:nil];
+		[self performSelector:@selector(setNeedsLayoutForLiveResize) withObject:nil afterDelay:JNWCollectionViewLiveResizeLayoutInterval - elapsed inModes:@[ NSRunLoopCommonModes ]];
+		return;
+	}
+	_lastLiveResizeLayoutTime = now;
+	
+	// Only the geometry which depends on the size is recalculated while resizing. Anything
+	// else the layout caches from the delegate, such as row heights, is refreshed once the
+	// resize ends.
+	CGRect visibleBounds = (CGRect){ .size = self.visibleSize };
+	BOOL shouldInvalidate = [self.collectionViewLayout shouldInvalidateLayoutForBoundsChange:visibleBounds];
+	[self.data recalculateAndPrepareLayoutForLiveResize:shouldInvalidate];
+	[self performFullRelayoutForcingSubviewsReset:NO];
+}
+
+- (void)setNeedsLayoutForLiveResize {
+	self.needsLayout = YES;
+}
+
+- (void)viewWillStartLiveResize {
+	[super viewWillStartLiveResize];
+	_lastLiveResizeLayoutTime = 0;
+}
+
+- (void)viewDidEndLiveResize {
+	[super viewDidEndLiveResize];
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(setNeedsLayoutForLiveResize) object:nil];
+	
+	if (_collectionViewFlags.wantsLayout) {
+		[self.data recalculateAndPrepareLayout:YES];
+		[self performFullRelayoutForcingSubviewsReset:NO];
+	}
+}
+
 - (void)reflectScrolledClipView:(NSClipView*)clipView {
     [super reflectScrolledClipView:clipView];
     
+    [self updateScrollVelocity];
+    [self finishAnimatedScrollIfArrived];
+    
+    // The item underneath the mouse changes as the content scrolls, even though the mouse doesn't move.
+    if (self.usesSingleTrackingArea && self.indexPathForHoveredItem != nil && self.window != nil) {
+        [self updateHoveredItemAtWindowLocation:self.window.mouseLocationOutsideOfEventStream withEvent:NSApp.currentEvent];
+    }
+    
     // 10.12 started optimizing the layout pass and reducing the number of calls to layout(). As
     // such, invalidate our layout when the scroll changes on 10.12 and above.
     if (floor(NSAppKitVersionNumber) > NSAppKitVersionNumber10_11) {
@@ -745,14 +1026,74 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[self performFullRelayoutForcingSubviewsReset:NO];
 }
 
+- (void)collectionViewLayout:(JNWCollectionViewLayout *)layout didChangeSectionGeometryAnimated:(BOOL)animated {
+	// The layout has already updated its geometry, so only the cached section frames and the size
+	// of the document view need to follow it.
+	[self.data recalculateAndPrepareLayout:NO];
+	
+	if (!animated || !_collectionViewFlags.wantsLayout || self.dataSource == nil) {
+		[self performFullRelayoutForcingSubviewsReset:NO];
+		return;
+	}
+	
+	[self layoutDocumentView];
+	
+	// Only the cells in the viewport take part in the animation. Cells that were visible move to
+	// their new frames, or to wherever the layout places them while collapsed, and are removed once
+	// the animation ends if they are no longer visible. Cells that become visible fade in.
+	NSDictionary *oldVisibleCellsMap = [self.visibleCellsMap copy];
+	NSSet *visibleIndexPaths = [NSSet setWithArray:[self indexPathsForItemsInRect:self.documentVisibleRect]];
+	
+	NSMutableArray *addedCells = [NSMutableArray array];
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	for (NSIndexPath *indexPath in visibleIndexPaths) {
+		if (oldVisibleCellsMap[indexPath] != nil)
+			continue;
+		
+		JNWCollectionViewCell *cell = [self addCellForIndexPath:indexPath];
+		cell.alphaValue = 0;
+		if (cell != nil) {
+			[addedCells addObject:cell];
+		}
+	}
+	[CATransaction commit];
+	
+	[NSAnimationContext runAnimationGroup:^(NSAnimationContext *context) {
+		context.allowsImplicitAnimation = YES;
+		
+		[oldVisibleCellsMap enumerateKeysAndObjectsUsingBlock:^(NSIndexPath *indexPath, JNWCollectionViewCell *cell, BOOL *stop) {
+			[self updateCell:cell forIndexPath:indexPath];
+		}];
+		for (JNWCollectionViewCell *cell in addedCells) {
+			cell.animator.alphaValue = cell.appliedLayoutAttributes.alpha;
+		}
+		
+		[self layoutSupplementaryViewsWithRedraw:YES];
+	} completionHandler:^{
+		NSSet *currentVisibleIndexPaths = [NSSet setWithArray:[self indexPathsForItemsInRect:self.documentVisibleRect]];
+		[oldVisibleCellsMap enumerateKeysAndObjectsUsingBlock:^(NSIndexPath *indexPath, JNWCollectionViewCell *cell, BOOL *stop) {
+			if (self.visibleCellsMap[indexPath] == cell && ![currentVisibleIndexPaths containsObject:indexPath]) {
+				[self removeAndEnqueueCellAtIndexPath:indexPath];
+			}
+		}];
+	}];
+	
+	_lastDrawnSize = self.visibleSize;
+}
+
 - (void)performFullRelayoutForcingSubviewsReset:(BOOL)forceReset {
 	if (forceReset && _collectionViewFlags.wantsLayout) {
 		[self resetAllCellsAndSupplementaryViews];
 	}
 	
+	// All view mutations in a layout pass are committed together, without implicit animations.
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
 	[self layoutDocumentView];
 	[self layoutCellsWithRedraw:YES];
 	[self layoutSupplementaryViewsWithRedraw:YES];
+	[CATransaction commit];
 	
 	_lastDrawnSize = self.visibleSize;
 }
@@ -793,6 +1134,11 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[self layoutCellsWithRedraw:NO];
 }
 
+// The time spent rendering snapshots of the cells leaving the viewport in a single layout pass, so that
+// ordinary scrolling doesn't pay for a snapshot of every cell. Cells past the budget are snapshotted the
+// next time they leave the viewport.
+static const CFTimeInterval JNWCollectionViewSnapshotBudgetPerLayout = 0.002;
+
 - (void)layoutCellsWithRedraw:(BOOL)needsVisibleRedraw {
 	if (self.dataSource == nil || !_collectionViewFlags.wantsLayout)
 		return;
@@ -815,18 +1161,22 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[indexPathsToAdd removeObjectsInArray:oldVisibleIndexPaths];
 	
 	// Remove old cells and put them in the reuse queue
+	CFTimeInterval snapshotDeadline = CACurrentMediaTime() + JNWCollectionViewSnapshotBudgetPerLayout;
 	for (NSIndexPath *indexPath in indexPathsToRemove) {
+		if (CACurrentMediaTime() < snapshotDeadline) {
+			[self snapshotCellIfNeededAtIndexPath:indexPath];
+		}
 		[self removeAndEnqueueCellAtIndexPath:indexPath];
 	}
 	
 	// Add the new cells
-	for (NSIndexPath *indexPath in indexPathsToAdd) {
-		[self addCellForIndexPath:indexPath];
-	}
+	[self addCellsForIndexPaths:indexPathsToAdd];
 }
 
 - (JNWCollectionViewCell*)addCellForIndexPath:(NSIndexPath*)indexPath {
+	self.indexPathForCellBeingAdded = indexPath;
 	JNWCollectionViewCell *cell = [self.dataSource collectionView:self cellForItemAtIndexPath:indexPath];
+	self.indexPathForCellBeingAdded = nil;
 	
 	// If any of these are true this cell isn't valid, and we'll be forced to skip it and throw the relevant exceptions.
 	if (cell == nil || ![cell isKindOfClass:JNWCollectionViewCell.class]) {
@@ -840,21 +1190,22 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 				 @"collectionView:cellForItemAtIndexPath: must return an instance or subclass of JNWCollectionViewCell.");
 		return nil;
 	}
+	
+	[self addCell:cell forIndexPath:indexPath];
+	return cell;
+}
+
+- (void)addCell:(JNWCollectionViewCell *)cell forIndexPath:(NSIndexPath *)indexPath {
 	cell.indexPath = indexPath;
 	cell.collectionView = self;
 	
 	[self updateLayoutAttributesForCell:cell indexPath:indexPath];
 	
-	[NSAnimationContext runAnimationGroup:^(NSAnimationContext *context) {
-		context.duration = 0;
-		[self updateCell:cell forIndexPath:indexPath];
-	} completionHandler:nil];
-	
-	if (cell.superview == nil) {
+	// Cells from a shared reuse pool may still be in the document view of another collection view.
+	if (cell.superview != self.documentView) {
 		[self.documentView addSubview:cell];
-	} else {
-		[cell setHidden:NO];
 	}
+	[cell setHidden:NO];
 		
 	if (_collectionViewFlags.delegateObjectValueForCell) {
 		if (cell.objectController) {
@@ -867,12 +1218,15 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	
 	[self updateSelectionStateOfCell:cell];
 	
-	return cell;
+	if (self.usesSingleTrackingArea) {
+		cell.hovered = [indexPath isEqual:self.indexPathForHoveredItem];
+	}
 }
 
 - (void)removeAndEnqueueCellAtIndexPath:(NSIndexPath*)indexPath {
 	JNWCollectionViewCell *cell = [self cellForItemAtIndexPath:indexPath];
 	[self.visibleCellsMap removeObjectForKey:indexPath];
+	[self.lightweightCellIndexPaths removeObject:indexPath];
 	[self enqueueReusableCell:cell withIdentifier:cell.reuseIdentifier];
 	[cell setHidden:YES];
 		
@@ -892,7 +1246,19 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	[self applyLayoutAttributes:attributes toCell:cell];
 }
 
+static BOOL JNWCollectionViewLayoutAttributesEqual(JNWCollectionViewLayoutAttributes *attributes, JNWCollectionViewLayoutAttributes *otherAttributes) {
+	return (CGRectEqualToRect(attributes.frame, otherAttributes.frame) &&
+			attributes.alpha == otherAttributes.alpha &&
+			attributes.zIndex == otherAttributes.zIndex);
+}
+
 - (void)applyLayoutAttributes:(JNWCollectionViewLayoutAttributes *)attributes toCell:(JNWCollectionViewCell *)cell {
+	JNWCollectionViewLayoutAttributes *appliedAttributes = cell.appliedLayoutAttributes;
+	if (appliedAttributes != nil && JNWCollectionViewLayoutAttributesEqual(appliedAttributes, attributes)) {
+		self.numberOfSkippedCellLayoutUpdates++;
+		return;
+	}
+	
 	[cell willLayoutWithFrame:attributes.frame];
 	
 	cell.frame = attributes.frame;
@@ -900,6 +1266,9 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	cell.layer.zPosition = attributes.zIndex;
 	
 	[cell didLayoutWithFrame:attributes.frame];
+	
+	cell.appliedLayoutAttributes = attributes;
+	self.numberOfAppliedCellLayoutUpdates++;
 }
 
 - (void)updateCell:(JNWCollectionViewCell*)cell forIndexPath:(NSIndexPath*)indexPath {
@@ -917,6 +1286,248 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	}
 }
 
+#pragma mark Cell creation budget
+
+// Cells deferred by the cell creation budget are picked up again after about one frame.
+static const NSTimeInterval JNWCollectionViewDeferredCellsInterval = 1.0 / 60.0;
+
+- (void)addCellsForIndexPaths:(NSArray *)indexPaths {
+	// While scrolling at high velocity, items with a snapshot are shown as a placeholder displaying it,
+	// and items without one get a lightweight cell if the data source provides them.
+	NSMutableArray *snapshotIndexPaths = [NSMutableArray array];
+	if (self.scrollingAtHighVelocity) {
+		NSMutableArray *remainingIndexPaths = [NSMutableArray arrayWithCapacity:indexPaths.count];
+		for (NSIndexPath *indexPath in indexPaths) {
+			if ([self snapshotForItemAtIndexPath:indexPath] != NULL) {
+				[snapshotIndexPaths addObject:indexPath];
+			} else if ([self addLightweightCellForIndexPath:indexPath] == nil) {
+				[remainingIndexPaths addObject:indexPath];
+			}
+		}
+		indexPaths = remainingIndexPaths;
+		self.numberOfSnapshotCells += snapshotIndexPaths.count;
+	}
+	
+	NSTimeInterval budget = self.cellCreationBudget;
+	if (budget <= 0) {
+		for (NSIndexPath *indexPath in indexPaths) {
+			[self addCellForIndexPath:indexPath];
+		}
+		if (snapshotIndexPaths.count > 0 || self.cellPlaceholders.count > 0) {
+			[self updateCellPlaceholdersForIndexPaths:snapshotIndexPaths];
+		}
+		return;
+	}
+	
+	// The cells closest to the middle of the visible area are created first, so that whatever is left
+	// over for the next frame is around the edges.
+	NSArray *sortedIndexPaths = indexPaths;
+	if (indexPaths.count > 1) {
+		CGRect visibleRect = self.documentVisibleRect;
+		CGPoint center = CGPointMake(CGRectGetMidX(visibleRect), CGRectGetMidY(visibleRect));
+		NSMutableDictionary *distances = [NSMutableDictionary dictionaryWithCapacity:indexPaths.count];
+		for (NSIndexPath *indexPath in indexPaths) {
+			CGRect frame = [self rectForItemAtIndexPath:indexPath];
+			distances[indexPath] = @(hypot(CGRectGetMidX(frame) - center.x, CGRectGetMidY(frame) - center.y));
+		}
+		sortedIndexPaths = [indexPaths sortedArrayUsingComparator:^NSComparisonResult(NSIndexPath *indexPath, NSIndexPath *otherIndexPath) {
+			return [distances[indexPath] compare:distances[otherIndexPath]];
+		}];
+	}
+	
+	CFTimeInterval start = CACurrentMediaTime();
+	NSMutableArray *deferredIndexPaths = [NSMutableArray array];
+	for (NSIndexPath *indexPath in sortedIndexPaths) {
+		if (CACurrentMediaTime() - start >= budget) {
+			[deferredIndexPaths addObject:indexPath];
+		} else {
+			[self addCellForIndexPath:indexPath];
+		}
+	}
+	CFTimeInterval duration = CACurrentMediaTime() - start;
+	
+	if (deferredIndexPaths.count > 0 || snapshotIndexPaths.count > 0 || self.cellPlaceholders.count > 0) {
+		[self updateCellPlaceholdersForIndexPaths:[snapshotIndexPaths arrayByAddingObjectsFromArray:deferredIndexPaths]];
+	}
+	
+	if (deferredIndexPaths.count > 0) {
+		self.numberOfDeferredCells += deferredIndexPaths.count;
+		
+		// The run loop modes include event tracking, so that the cells are finished while the scroller is dragged.
+		[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(setNeedsLayoutForDeferredCells) object:nil];
+		[self performSelector:@selector(setNeedsLayoutForDeferredCells) withObject:nil afterDelay:JNWCollectionViewDeferredCellsInterval inModes:@[ NSRunLoopCommonModes ]];
+	}
+	
+	if (duration > budget) {
+		self.numberOfCellCreationBudgetOverruns++;
+		if (_collectionViewFlags.delegateDidExceedCellCreationBudget) {
+			[self.delegate collectionView:self didExceedCellCreationBudgetWithDuration:duration numberOfDeferredCells:deferredIndexPaths.count];
+		}
+	}
+}
+
+- (void)setNeedsLayoutForDeferredCells {
+	self.needsLayout = YES;
+}
+
+/// Shows placeholders for the index paths, and hides the placeholders of any other index paths. Placeholders
+/// display the snapshot of their item if there is one, and `cellPlaceholderColor` otherwise.
+- (void)updateCellPlaceholdersForIndexPaths:(NSArray *)indexPaths {
+	NSSet *placeholderIndexPaths = [NSSet setWithArray:indexPaths];
+	for (NSIndexPath *indexPath in self.cellPlaceholders.allKeys) {
+		if (![placeholderIndexPaths containsObject:indexPath]) {
+			NSView *placeholder = self.cellPlaceholders[indexPath];
+			placeholder.hidden = YES;
+			placeholder.layer.contents = nil;
+			[self.reusableCellPlaceholders addObject:placeholder];
+			[self.cellPlaceholders removeObjectForKey:indexPath];
+		}
+	}
+	
+	for (NSIndexPath *indexPath in indexPaths) {
+		NSView *placeholder = self.cellPlaceholders[indexPath];
+		if (placeholder == nil) {
+			placeholder = self.reusableCellPlaceholders.lastObject;
+			if (placeholder != nil) {
+				[self.reusableCellPlaceholders removeLastObject];
+			} else {
+				placeholder = [[NSView alloc] initWithFrame:CGRectZero];
+				placeholder.wantsLayer = YES;
+				[self.documentView addSubview:placeholder];
+			}
+			self.cellPlaceholders[indexPath] = placeholder;
+		}
+		
+		CGImageRef snapshot = [self snapshotForItemAtIndexPath:indexPath];
+		placeholder.frame = [self rectForItemAtIndexPath:indexPath];
+		placeholder.layer.contents = (__bridge id)snapshot;
+		placeholder.layer.backgroundColor = (snapshot != NULL ? NULL : self.cellPlaceholderColor.CGColor);
+		placeholder.hidden = NO;
+	}
+}
+
+#pragma mark High velocity scrolling
+
+// Once scrolling at high velocity, the velocity has to drop below this fraction of the threshold
+// before full cells are restored, so that scrolling right around the threshold doesn't flip back and forth.
+static const CGFloat JNWCollectionViewHighVelocityExitFraction = 0.5;
+
+// Scrolling is considered to have stopped when there hasn't been a scroll for this long.
+static const NSTimeInterval JNWCollectionViewHighVelocityIdleInterval = 0.1;
+
+- (void)setHighVelocityScrollThreshold:(CGFloat)highVelocityScrollThreshold {
+	_highVelocityScrollThreshold = highVelocityScrollThreshold;
+	
+	if (highVelocityScrollThreshold <= 0) {
+		[self endHighVelocityScrolling];
+		[self.snapshotCache removeAllSnapshots];
+	}
+}
+
+- (NSUInteger)snapshotCacheSizeLimit {
+	return self.snapshotCache.totalCostLimit;
+}
+
+- (void)setSnapshotCacheSizeLimit:(NSUInteger)snapshotCacheSizeLimit {
+	self.snapshotCache.totalCostLimit = snapshotCacheSizeLimit;
+}
+
+- (void)updateScrollVelocity {
+	CGFloat threshold = self.highVelocityScrollThreshold;
+	if (threshold <= 0)
+		return;
+	
+	CFTimeInterval now = CACurrentMediaTime();
+	CGPoint origin = self.documentVisibleRect.origin;
+	CFTimeInterval elapsed = now - _lastScrollTime;
+	if (elapsed > JNWCollectionViewHighVelocityIdleInterval) {
+		// The first scroll after a pause, or a programmatic jump, says nothing about the velocity.
+		_scrollVelocity = 0;
+	} else if (elapsed > 0) {
+		// Individual scroll events are uneven, so the velocity is smoothed over the last few of them.
+		CGFloat velocity = hypot(origin.x - _lastScrollOrigin.x, origin.y - _lastScrollOrigin.y) / elapsed;
+		_scrollVelocity = (_scrollVelocity + velocity) / 2;
+	}
+	_lastScrollTime = now;
+	_lastScrollOrigin = origin;
+	
+	if (!self.scrollingAtHighVelocity && _scrollVelocity > threshold) {
+		self.scrollingAtHighVelocity = YES;
+	} else if (self.scrollingAtHighVelocity && _scrollVelocity < threshold * JNWCollectionViewHighVelocityExitFraction) {
+		[self endHighVelocityScrolling];
+	}
+	
+	if (self.scrollingAtHighVelocity) {
+		[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(endHighVelocityScrolling) object:nil];
+		[self performSelector:@selector(endHighVelocityScrolling) withObject:nil afterDelay:JNWCollectionViewHighVelocityIdleInterval inModes:@[ NSRunLoopCommonModes ]];
+	}
+}
+
+- (void)endHighVelocityScrolling {
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(endHighVelocityScrolling) object:nil];
+	if (!self.scrollingAtHighVelocity)
+		return;
+	
+	self.scrollingAtHighVelocity = NO;
+	_scrollVelocity = 0;
+	
+	// Lightweight cells are swapped for full cells, and snapshots for cells, in a single pass so
+	// that nothing flickers in between.
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	for (NSIndexPath *indexPath in self.lightweightCellIndexPaths.allObjects) {
+		[self removeAndEnqueueCellAtIndexPath:indexPath];
+	}
+	[self layoutCellsWithRedraw:NO];
+	[CATransaction commit];
+}
+
+- (JNWCollectionViewCell *)addLightweightCellForIndexPath:(NSIndexPath *)indexPath {
+	if (!_collectionViewFlags.dataSourceLightweightCell)
+		return nil;
+	
+	self.indexPathForCellBeingAdded = indexPath;
+	JNWCollectionViewCell *cell = [self.dataSource collectionView:self lightweightCellForItemAtIndexPath:indexPath];
+	self.indexPathForCellBeingAdded = nil;
+	
+	if (cell == nil)
+		return nil;
+	NSAssert([cell isKindOfClass:JNWCollectionViewCell.class],
+			 @"collectionView:lightweightCellForItemAtIndexPath: must return an instance or subclass of JNWCollectionViewCell.");
+	
+	[self addCell:cell forIndexPath:indexPath];
+	[self.lightweightCellIndexPaths addObject:indexPath];
+	self.numberOfLightweightCells++;
+	
+	return cell;
+}
+
+/// Returns the snapshot of the item if it still matches the item's current size and selection state.
+- (CGImageRef)snapshotForItemAtIndexPath:(NSIndexPath *)indexPath {
+	if (self.highVelocityScrollThreshold <= 0)
+		return NULL;
+	
+	CGSize size = [self rectForItemAtIndexPath:indexPath].size;
+	id objectValue = (_collectionViewFlags.delegateObjectValueForCell ? [self.delegate collectionView:self objectValueForItemAtIndexPath:indexPath] : nil);
+	return [self.snapshotCache snapshotForItemAtIndexPath:indexPath size:size selected:[self.selectedIndexes containsObject:indexPath] objectValue:objectValue];
+}
+
+// Cells are snapshotted as they scroll out of view at a normal speed, once per item until the snapshot
+// is invalidated, so that the snapshot is ready if the item comes back into view at high velocity.
+- (void)snapshotCellIfNeededAtIndexPath:(NSIndexPath *)indexPath {
+	if (self.highVelocityScrollThreshold <= 0 || self.scrollingAtHighVelocity || [self.lightweightCellIndexPaths containsObject:indexPath])
+		return;
+	
+	JNWCollectionViewCell *cell = self.visibleCellsMap[indexPath];
+	if (cell == nil || cell.alphaValue == 0)
+		return;
+	
+	// A cell that was given a new object value since its last snapshot is snapshotted again.
+	if ([self.snapshotCache snapshotForItemAtIndexPath:indexPath size:cell.bounds.size selected:cell.selected objectValue:cell.objectValue] == NULL) {
+		[self.snapshotCache addSnapshotOfCell:cell forItemAtIndexPath:indexPath];
+	}
+}
+
 #pragma mark Supplementary Views
 
 - (NSArray *)allSupplementaryViewIdentifiers {
@@ -971,6 +1582,19 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 			JNWCollectionViewLayoutAttributes *attributes = [self.collectionViewLayout layoutAttributesForSupplementaryItemInSection:section kind:kind];
 			[self applyLayoutAttributes:attributes toSupplementaryView:view];
 		}
+	} else {
+		// Only the views whose position depends on the scroll offset (such as sticky headers) need updating.
+		NSArray *scrollDependentKinds = [self.collectionViewLayout scrollDependentSupplementaryItemKinds];
+		if (scrollDependentKinds.count > 0) {
+			[self.visibleSupplementaryViewsMap enumerateKeysAndObjectsUsingBlock:^(NSString *layoutIdentifier, JNWCollectionViewReusableView *view, BOOL *stop) {
+				if (![scrollDependentKinds containsObject:view.kind])
+					return;
+				
+				NSInteger section = [self sectionForSupplementaryLayoutIdentifier:layoutIdentifier];
+				JNWCollectionViewLayoutAttributes *attributes = [self.collectionViewLayout layoutAttributesForSupplementaryItemInSection:section kind:view.kind];
+				[self applyLayoutAttributes:attributes toSupplementaryView:view];
+			}];
+		}
 	}
 	
 	// Here's the strategy. There can only be one supplementary view for each kind in every section. Now this supplementary view
@@ -1009,9 +1633,13 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 				 NSStringFromSelector(@selector(collectionView:viewForSupplementaryViewOfKind:inSection:)), NSStringFromClass(JNWCollectionViewReusableView.class));
 		
 		JNWCollectionViewLayoutAttributes *attributes = [self.collectionViewLayout layoutAttributesForSupplementaryItemInSection:section kind:kind];
-		view.frame = attributes.frame;
-		view.alphaValue = attributes.alpha;
-		[self.documentView addSubview:view];
+		[self applyLayoutAttributes:attributes toSupplementaryView:view];
+		
+		// Views recycled on reload are still in a document view, possibly that of another collection view sharing the pool.
+		if (view.superview != self.documentView) {
+			[self.documentView addSubview:view];
+		}
+		[view setHidden:NO];
 		
 		self.visibleSupplementaryViewsMap[layoutIdentifier] = view;
 	}
@@ -1023,6 +1651,20 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	view.layer.zPosition = attributes.zIndex;
 }
 
+#pragma mark Statistics
+
+- (void)resetStatistics {
+	self.numberOfAppliedCellLayoutUpdates = 0;
+	self.numberOfSkippedCellLayoutUpdates = 0;
+	self.numberOfCreatedCells = 0;
+	self.numberOfCreatedSupplementaryViews = 0;
+	self.numberOfReloads = 0;
+	self.numberOfDeferredCells = 0;
+	self.numberOfCellCreationBudgetOverruns = 0;
+	self.numberOfSnapshotCells = 0;
+	self.numberOfLightweightCells = 0;
+}
+
 #pragma mark Mouse events and selection
 
 - (BOOL)canBecomeKeyView {
@@ -1303,6 +1945,341 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	cell.hovered = NO;
 }
 
+#pragma mark Marquee selection
+
+// Writes the parts of `rect` which are not covered by `subtractedRect` into `pieces` as up to four
+// non-overlapping rects, returning how many were written.
+static NSUInteger JNWCollectionViewRectSubtract(CGRect rect, CGRect subtractedRect, CGRect pieces[4]) {
+	if (CGRectIsEmpty(rect))
+		return 0;
+	
+	CGRect intersection = CGRectIntersection(rect, subtractedRect);
+	if (CGRectIsEmpty(intersection)) {
+		pieces[0] = rect;
+		return 1;
+	}
+	
+	CGRect candidates[4] = {
+		CGRectMake(rect.origin.x, rect.origin.y, rect.size.width, CGRectGetMinY(intersection) - CGRectGetMinY(rect)),
+		CGRectMake(rect.origin.x, CGRectGetMaxY(intersection), rect.size.width, CGRectGetMaxY(rect) - CGRectGetMaxY(intersection)),
+		CGRectMake(rect.origin.x, intersection.origin.y, CGRectGetMinX(intersection) - CGRectGetMinX(rect), intersection.size.height),
+		CGRectMake(CGRectGetMaxX(intersection), intersection.origin.y, CGRectGetMaxX(rect) - CGRectGetMaxX(intersection), intersection.size.height)
+	};
+	
+	NSUInteger count = 0;
+	for (NSUInteger i = 0; i < 4; i++) {
+		if (candidates[i].size.width > 0 && candidates[i].size.height > 0) {
+			pieces[count++] = candidates[i];
+		}
+	}
+	return count;
+}
+
+- (BOOL)beginMarqueeSelectionWithEvent:(NSEvent *)event {
+	if (!self.allowsMarqueeSelection || !self.allowsSelection || !self.allowsMultipleSelection)
+		return NO;
+	
+	NSPoint point = [self.documentView convertPoint:event.locationInWindow fromView:nil];
+	if ([self indexPathForItemAtPoint:point] != nil)
+		return NO;
+	
+	[self.window makeFirstResponder:self];
+	
+	// Command toggles the items under the marquee and shift adds them to the selection. Otherwise
+	// the marquee replaces the selection.
+	self.marqueeTogglesSelection = (event.modifierFlags & NSCommandKeyMask) != 0;
+	// Only the selected items are deselected, rather than every item as -deselectAllItems does.
+	if (!self.marqueeTogglesSelection && !(event.modifierFlags & NSShiftKeyMask) && self.allowsEmptySelection && self.selectedIndexes.count > 0) {
+		[self deselectItemsAtIndexPaths:[self.selectedIndexes copy] animated:YES];
+	}
+	
+	self.marqueeOrigin = point;
+	self.marqueeRect = CGRectNull;
+	self.marqueeInitialSelection = [NSSet setWithArray:self.selectedIndexes];
+	self.marqueeSelection = [NSMutableSet setWithSet:self.marqueeInitialSelection];
+	self.marqueeCoveredIndexes = [NSMutableDictionary dictionary];
+	
+	NSView *marqueeView = [[NSView alloc] initWithFrame:CGRectZero];
+	marqueeView.wantsLayer = YES;
+	marqueeView.layer.backgroundColor = [NSColor.alternateSelectedControlColor colorWithAlphaComponent:0.2].CGColor;
+	marqueeView.layer.borderColor = [NSColor.alternateSelectedControlColor colorWithAlphaComponent:0.8].CGColor;
+	marqueeView.layer.borderWidth = 1;
+	self.marqueeView = marqueeView;
+	
+	return YES;
+}
+
+- (void)updateMarqueeSelection {
+	NSPoint point = [self.documentView convertPoint:self.window.mouseLocationOutsideOfEventStream fromView:nil];
+	
+	// The layout only scrolls for points inside the visible rect, so points past the edges are pulled
+	// back in, letting the marquee keep scrolling while the mouse is outside of the collection view.
+	CGRect visibleRect = self.documentVisibleRect;
+	CGPoint scrollPoint = CGPointMake(MIN(MAX(point.x, CGRectGetMinX(visibleRect)), CGRectGetMaxX(visibleRect) - 1),
+									  MIN(MAX(point.y, CGRectGetMinY(visibleRect)), CGRectGetMaxY(visibleRect) - 1));
+	[self.collectionViewLayout scrollIfNecessaryForDragAtPoint:scrollPoint];
+	
+	CGRect documentBounds = [self.documentView bounds];
+	point.x = MIN(MAX(point.x, CGRectGetMinX(documentBounds)), CGRectGetMaxX(documentBounds));
+	point.y = MIN(MAX(point.y, CGRectGetMinY(documentBounds)), CGRectGetMaxY(documentBounds));
+	
+	CGRect rect = CGRectMake(MIN(point.x, self.marqueeOrigin.x), MIN(point.y, self.marqueeOrigin.y),
+							 ABS(point.x - self.marqueeOrigin.x), ABS(point.y - self.marqueeOrigin.y));
+	
+	self.marqueeView.frame = rect;
+	if ([self.documentView subviews].lastObject != self.marqueeView) {
+		[self.documentView addSubview:self.marqueeView positioned:NSWindowAbove relativeTo:nil];
+	}
+	
+	[self updateMarqueeSelectionForRect:rect];
+}
+
+- (void)updateMarqueeSelectionForRect:(CGRect)rect {
+	CGRect previousRect = self.marqueeRect;
+	self.marqueeRect = rect;
+	
+	// Only the items in the areas swept since the last update can have entered or left the marquee, so
+	// those are the only areas queried. This keeps the cost of each update proportional to the distance
+	// the mouse moved, rather than to the number of items under the marquee.
+	NSMutableArray *enteredIndexPaths = [NSMutableArray array];
+	NSMutableArray *exitedIndexPaths = [NSMutableArray array];
+	CGRect pieces[4];
+	
+	NSUInteger count = JNWCollectionViewRectSubtract(rect, previousRect, pieces);
+	for (NSUInteger i = 0; i < count; i++) {
+		for (NSIndexPath *indexPath in [self indexPathsForItemsInRect:pieces[i]]) {
+			NSMutableIndexSet *coveredIndexes = self.marqueeCoveredIndexes[@(indexPath.jnw_section)];
+			if ([coveredIndexes containsIndex:indexPath.jnw_item] || !CGRectIntersectsRect([self rectForItemAtIndexPath:indexPath], rect))
+				continue;
+			
+			if (coveredIndexes == nil) {
+				coveredIndexes = [NSMutableIndexSet indexSet];
+				self.marqueeCoveredIndexes[@(indexPath.jnw_section)] = coveredIndexes;
+			}
+			[coveredIndexes addIndex:indexPath.jnw_item];
+			[enteredIndexPaths addObject:indexPath];
+		}
+	}
+	
+	count = JNWCollectionViewRectSubtract(previousRect, rect, pieces);
+	for (NSUInteger i = 0; i < count; i++) {
+		for (NSIndexPath *indexPath in [self indexPathsForItemsInRect:pieces[i]]) {
+			NSMutableIndexSet *coveredIndexes = self.marqueeCoveredIndexes[@(indexPath.jnw_section)];
+			if (![coveredIndexes containsIndex:indexPath.jnw_item] || CGRectIntersectsRect([self rectForItemAtIndexPath:indexPath], rect))
+				continue;
+			
+			[coveredIndexes removeIndex:indexPath.jnw_item];
+			[exitedIndexPaths addObject:indexPath];
+		}
+	}
+	
+	// Items under the marquee are selected, or flipped when toggling, and items which leave it go back
+	// to how they were before the marquee started.
+	NSMutableArray *indexPathsToSelect = [NSMutableArray array];
+	NSMutableArray *indexPathsToDeselect = [NSMutableArray array];
+	for (NSIndexPath *indexPath in enteredIndexPaths) {
+		BOOL initiallySelected = [self.marqueeInitialSelection containsObject:indexPath];
+		BOOL selected = (self.marqueeTogglesSelection ? !initiallySelected : YES);
+		[(selected ? indexPathsToSelect : indexPathsToDeselect) addObject:indexPath];
+	}
+	for (NSIndexPath *indexPath in exitedIndexPaths) {
+		BOOL initiallySelected = [self.marqueeInitialSelection containsObject:indexPath];
+		[(initiallySelected ? indexPathsToSelect : indexPathsToDeselect) addObject:indexPath];
+	}
+	
+	[self applyMarqueeSelectionBySelectingItemsAtIndexPaths:indexPathsToSelect deselectingItemsAtIndexPaths:indexPathsToDeselect];
+}
+
+- (void)applyMarqueeSelectionBySelectingItemsAtIndexPaths:(NSArray *)indexPathsToSelect deselectingItemsAtIndexPaths:(NSArray *)indexPathsToDeselect {
+	// The selected index paths are kept in an array, so the changes are applied in bulk against a set
+	// rather than going through -selectItemAtIndexPath:, which would search the array for every item.
+	NSMutableArray *selectedIndexPaths = [NSMutableArray array];
+	for (NSIndexPath *indexPath in indexPathsToSelect) {
+		if ([self.marqueeSelection containsObject:indexPath] ||
+			(_collectionViewFlags.delegateShouldSelect && ![self.delegate collectionView:self shouldSelectItemAtIndexPath:indexPath])) {
+			continue;
+		}
+		[self.marqueeSelection addObject:indexPath];
+		[selectedIndexPaths addObject:indexPath];
+	}
+	
+	NSMutableSet *deselectedIndexPaths = [NSMutableSet set];
+	for (NSIndexPath *indexPath in indexPathsToDeselect) {
+		if (![self.marqueeSelection containsObject:indexPath] ||
+			(!self.allowsEmptySelection && self.marqueeSelection.count <= 1) ||
+			(_collectionViewFlags.delegateShouldDeselect && ![self.delegate collectionView:self shouldDeselectItemAtIndexPath:indexPath])) {
+			continue;
+		}
+		[self.marqueeSelection removeObject:indexPath];
+		[deselectedIndexPaths addObject:indexPath];
+	}
+	
+	if (selectedIndexPaths.count == 0 && deselectedIndexPaths.count == 0)
+		return;
+	
+	[self.selectedIndexes addObjectsFromArray:selectedIndexPaths];
+	if (deselectedIndexPaths.count > 0) {
+		[self.selectedIndexes removeObjectsAtIndexes:[self.selectedIndexes indexesOfObjectsPassingTest:^BOOL(NSIndexPath *indexPath, NSUInteger idx, BOOL *stop) {
+			return [deselectedIndexPaths containsObject:indexPath];
+		}]];
+	}
+	
+	for (NSIndexPath *indexPath in selectedIndexPaths) {
+		[[self cellForItemAtIndexPath:indexPath] setSelected:YES animated:self.animatesSelection];
+		if (self.sendsMultipleSelectionCalls && _collectionViewFlags.delegateDidSelect) {
+			[self.delegate collectionView:self didSelectItemAtIndexPath:indexPath];
+		}
+	}
+	for (NSIndexPath *indexPath in deselectedIndexPaths) {
+		[[self cellForItemAtIndexPath:indexPath] setSelected:NO animated:self.animatesSelection];
+		if (self.sendsMultipleSelectionCalls && _collectionViewFlags.delegateDidDeselect) {
+			[self.delegate collectionView:self didDeselectItemAtIndexPath:indexPath];
+		}
+	}
+	
+	if (!self.sendsMultipleSelectionCalls) {
+		if (selectedIndexPaths.count > 0 && _collectionViewFlags.delegateDidSelectMult) {
+			[self.delegate collectionView:self didSelectItemsAtIndexPaths:[NSSet setWithArray:selectedIndexPaths]];
+		}
+		if (deselectedIndexPaths.count > 0 && _collectionViewFlags.delegateDidDeselectMult) {
+			[self.delegate collectionView:self didDeselectItemsAtIndexPaths:deselectedIndexPaths];
+		}
+	}
+	if (_collectionViewFlags.delegateDidSelectItemsChange) {
+		[self.delegate collectionView:self selectedItemsChangedToIndexPaths:[self.marqueeSelection copy]];
+	}
+}
+
+- (void)endMarqueeSelection {
+	[self.marqueeView removeFromSuperview];
+	self.marqueeView = nil;
+	self.marqueeInitialSelection = nil;
+	self.marqueeSelection = nil;
+	self.marqueeCoveredIndexes = nil;
+}
+
+- (void)mouseDown:(NSEvent *)event {
+	// Clicks on cells are forwarded up the responder chain after the cell has handled them, so only
+	// clicks outside of the items start a marquee.
+	if (![self beginMarqueeSelectionWithEvent:event]) {
+		[super mouseDown:event];
+		return;
+	}
+	
+	// Periodic events keep the marquee scrolling while the mouse is held still near an edge.
+	[NSEvent startPeriodicEventsAfterDelay:0.1 withPeriod:0.05];
+	
+	NSEvent *currentEvent = event;
+	while (currentEvent.type != NSLeftMouseUp) {
+		currentEvent = [self.window nextEventMatchingMask:(NSLeftMouseDraggedMask | NSLeftMouseUpMask | NSPeriodicMask)];
+		[self updateMarqueeSelection];
+	}
+	
+	[NSEvent stopPeriodicEvents];
+	[self endMarqueeSelection];
+}
+
+#pragma mark Hover tracking
+
+- (void)setUsesSingleTrackingArea:(BOOL)usesSingleTrackingArea {
+	if (_usesSingleTrackingArea == usesSingleTrackingArea)
+		return;
+	
+	_usesSingleTrackingArea = usesSingleTrackingArea;
+	self.indexPathForHoveredItem = nil;
+	
+	// Give the cells a chance to install or remove their own tracking areas.
+	for (JNWCollectionViewCell *cell in self.visibleCellsMap.allValues) {
+		cell.hovered = NO;
+		[cell updateTrackingAreas];
+	}
+	[self.reusePool enumerateCellsUsingBlock:^(JNWCollectionViewCell *cell) {
+		if (cell.collectionView == self) {
+			[cell updateTrackingAreas];
+		}
+	}];
+	
+	[self updateTrackingAreas];
+}
+
+- (void)updateTrackingAreas {
+	[super updateTrackingAreas];
+	
+	if (self.hoverTrackingArea != nil) {
+		[self removeTrackingArea:self.hoverTrackingArea];
+		self.hoverTrackingArea = nil;
+	}
+	
+	if (!self.usesSingleTrackingArea)
+		return;
+	
+	NSTrackingAreaOptions options = (NSTrackingActiveAlways | NSTrackingInVisibleRect | NSTrackingMouseEnteredAndExited | NSTrackingMouseMoved);
+	self.hoverTrackingArea = [[NSTrackingArea alloc] initWithRect:self.bounds options:options owner:self userInfo:nil];
+	[self addTrackingArea:self.hoverTrackingArea];
+}
+
+- (void)mouseEntered:(NSEvent *)event {
+	[super mouseEntered:event];
+	
+	if (self.usesSingleTrackingArea) {
+		[self updateHoveredItemAtWindowLocation:event.locationInWindow withEvent:event];
+	}
+}
+
+- (void)mouseMoved:(NSEvent *)event {
+	[super mouseMoved:event];
+	
+	if (self.usesSingleTrackingArea) {
+		[self updateHoveredItemAtWindowLocation:event.locationInWindow withEvent:event];
+		
+		NSIndexPath *indexPath = self.indexPathForHoveredItem;
+		if (indexPath != nil && _collectionViewFlags.delegateMouseMoved) {
+			[self.delegate collectionView:self mouseMovedInItemAtIndexPath:indexPath withEvent:event];
+		}
+	}
+}
+
+- (void)mouseExited:(NSEvent *)event {
+	[super mouseExited:event];
+	
+	if (self.usesSingleTrackingArea) {
+		[self setHoveredItemAtIndexPath:nil withEvent:event];
+	}
+}
+
+- (void)updateHoveredItemAtWindowLocation:(NSPoint)windowLocation withEvent:(NSEvent *)event {
+	NSPoint point = [self.documentView convertPoint:windowLocation fromView:nil];
+	NSIndexPath *indexPath = nil;
+	
+	if (NSPointInRect(point, self.documentVisibleRect)) {
+		indexPath = [self indexPathForItemAtPoint:point];
+	}
+	
+	[self setHoveredItemAtIndexPath:indexPath withEvent:event];
+}
+
+- (void)setHoveredItemAtIndexPath:(NSIndexPath *)indexPath withEvent:(NSEvent *)event {
+	NSIndexPath *previousIndexPath = self.indexPathForHoveredItem;
+	if (previousIndexPath == indexPath || [previousIndexPath isEqual:indexPath])
+		return;
+	
+	self.indexPathForHoveredItem = indexPath;
+	
+	if (previousIndexPath != nil) {
+		[self cellForItemAtIndexPath:previousIndexPath].hovered = NO;
+		if (_collectionViewFlags.delegateMouseExited) {
+			[self.delegate collectionView:self mouseExitedInItemAtIndexPath:previousIndexPath withEvent:event];
+		}
+	}
+	
+	if (indexPath != nil) {
+		[self cellForItemAtIndexPath:indexPath].hovered = YES;
+		if (_collectionViewFlags.delegateMouseEntered) {
+			[self.delegate collectionView:self mouseEnteredInItemAtIndexPath:indexPath withEvent:event];
+		}
+	}
+}
+
 - (void)doubleClickInCollectionViewCell:(JNWCollectionViewCell *)cell withEvent:(NSEvent *)event {
 	if (_collectionViewFlags.delegateDidDoubleClick) {
 		NSIndexPath *indexPath = [self indexPathForCell:cell];
@@ -1456,7 +2433,7 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	// Check whether the drop path has changed. Avoid repeated calls when both the old and new path are nil.
 	if (![self.dragContext.dropPath isEqual:dropPath] && !(dropPath == nil && _dragContext.dropPath == nil)) {
 		self.dragContext.dropPath = dropPath;
-		[self.collectionViewLayout prepareLayout];
+		[self.collectionViewLayout prepareDropMarker];
 		[self updateDropMarker];
 	}
 	return [sender draggingSourceOperationMask]; // we're only supposed to return 1 NSDragOperation, but this could potentially return multiple. TODO:
@@ -1465,7 +2442,7 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 - (void)draggingExited:(id<NSDraggingInfo>)sender {
 	// Drag has left the view. Clean up the context so that the drag marker no longer displays.
     _dragContext = nil;
-    [self.collectionViewLayout prepareLayout];
+    [self.collectionViewLayout prepareDropMarker];
     [self updateDropMarker];
 }
 
@@ -1473,7 +2450,7 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	//NSLog(@"Dragging ended at point");
 	if (self.dragContext) {
 		_dragContext = nil;
-		[self.collectionViewLayout prepareLayout];
+		[self.collectionViewLayout prepareDropMarker];
 		[self updateDropMarker];
 	}
 }
@@ -1490,7 +2467,7 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 		JNWCollectionViewDropIndexPath *toIndexPath = self.dragContext.dropPath;
 		
 		_dragContext = nil;
-		[self.collectionViewLayout prepareLayout];
+		[self.collectionViewLayout prepareDropMarker];
 		[self updateDropMarker];
 		
 		result = [self.dragDropDelegate collectionView:self performDragOperation:sender fromIndexPaths:fromIndexPath toIndexPath:toIndexPath];
@@ -1502,29 +2479,57 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 - (void)updateDropMarker {
 	if (_collectionViewFlags.dragDropDelegateDropMarker || _collectionViewFlags.dragDropDelegateDropMarkerForIndexPath) {
 		JNWCollectionViewLayoutAttributes *attributes = [self.collectionViewLayout layoutAttributesForDropMarker];
-		NSView *markerView;
-		if (attributes) {
-			// Ideally, dropMarkerViewWithFrame would know the JNWCollectionViewDropRelation so that it could draw itself differently
-			// depending on where the item should be dropped.
-			if (_collectionViewFlags.dragDropDelegateDropMarkerForIndexPath) {
-				markerView = [self.dragDropDelegate collectionView:self dropMarkerViewWithFrame:attributes.frame forIndexPath:self.dragContext.dropPath];
+		if (attributes == nil) {
+			// Keep the marker around while the drag is still in progress so it can be moved
+			// back into place without asking the delegate for a new view.
+			if (self.dragContext != nil) {
+				self.dropMarker.hidden = YES;
+			} else {
+				[self.dropMarker removeFromSuperview];
+				self.dropMarker = nil;
+				self.dropMarkerDropPath = nil;
 			}
-			else {
+			return;
+		}
+		
+		// If the marker has the same size as before, it only needs to be moved. The delegate is free to return
+		// a view larger than the marker frame, so it's offset by the same amount the marker frame has moved.
+		// A marker created for a drop path can only be moved while the drop path stays the same.
+		JNWCollectionViewDropIndexPath *dropPath = self.dragContext.dropPath;
+		BOOL markerMatchesDropPath = (!_collectionViewFlags.dragDropDelegateDropMarkerForIndexPath ||
+									  self.dropMarkerDropPath == dropPath || [self.dropMarkerDropPath isEqual:dropPath]);
+		if (self.dropMarker != nil && markerMatchesDropPath && CGSizeEqualToSize(attributes.frame.size, _lastDropMarkerFrame.size)) {
+			NSRect markerFrame = self.dropMarker.frame;
+			markerFrame.origin.x += attributes.frame.origin.x - _lastDropMarkerFrame.origin.x;
+			markerFrame.origin.y += attributes.frame.origin.y - _lastDropMarkerFrame.origin.y;
+			self.dropMarker.frame = markerFrame;
+			self.dropMarker.alphaValue = attributes.alpha;
+			self.dropMarker.hidden = NO;
+			_lastDropMarkerFrame = attributes.frame;
+			return;
+		}
+		
+		NSView *markerView;
+		// Ideally, dropMarkerViewWithFrame would know the JNWCollectionViewDropRelation so that it could draw itself differently
+		// depending on where the item should be dropped.
+		if (_collectionViewFlags.dragDropDelegateDropMarkerForIndexPath) {
+			markerView = [self.dragDropDelegate collectionView:self dropMarkerViewWithFrame:attributes.frame forIndexPath:dropPath];
+		}
+		else {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-				markerView = [self.dragDropDelegate collectionView:self dropMarkerViewWithFrame:attributes.frame];
+			markerView = [self.dragDropDelegate collectionView:self dropMarkerViewWithFrame:attributes.frame];
 #pragma clang diagnostic pop
-			}
-			markerView.alphaValue = attributes.alpha;
-		} else {
-			markerView = nil;
 		}
+		markerView.alphaValue = attributes.alpha;
 		
 		[self.dropMarker removeFromSuperview];
 		if (markerView) {
 			[self.documentView addSubview:markerView];
 		}
 		self.dropMarker = markerView;
+		self.dropMarkerDropPath = dropPath;
+		_lastDropMarkerFrame = attributes.frame;
 	}
 }
 
@@ -1555,6 +2560,64 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 
 #pragma mark NSResponder
 
+// The typed characters are discarded after this long without another key press, as in NSTableView.
+static const NSTimeInterval JNWCollectionViewTypeSelectTimeout = 1.0;
+
+- (void)keyDown:(NSEvent *)event {
+	if (![self handleTypeSelectEvent:event]) {
+		[super keyDown:event];
+	}
+}
+
+- (BOOL)handleTypeSelectEvent:(NSEvent *)event {
+	if (!_collectionViewFlags.dataSourceTypeSelectString || !self.allowsSelection)
+		return NO;
+	
+	if ((event.modifierFlags & (NSCommandKeyMask | NSControlKeyMask)) != 0)
+		return NO;
+	
+	NSString *characters = event.characters;
+	if (characters.length == 0)
+		return NO;
+	
+	// Arrow keys and other function keys are in the private use area, and are handled elsewhere.
+	NSMutableCharacterSet *ignoredCharacters = [NSMutableCharacterSet controlCharacterSet];
+	[ignoredCharacters addCharactersInRange:NSMakeRange(0xF700, 0x100)];
+	if ([characters rangeOfCharacterFromSet:ignoredCharacters].location != NSNotFound)
+		return NO;
+	
+	if (self.typeSelectString == nil || event.timestamp - self.lastTypeSelectTimestamp > JNWCollectionViewTypeSelectTimeout) {
+		self.typeSelectString = [NSMutableString string];
+	}
+	
+	// A leading space is left to the responder chain, as it usually means something else, such as Quick Look.
+	if (self.typeSelectString.length == 0 && [characters stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]].length == 0)
+		return NO;
+	
+	[self.typeSelectString appendString:characters];
+	self.lastTypeSelectTimestamp = event.timestamp;
+	
+	if (self.typeSelectIndex == nil) {
+		self.typeSelectIndex = [[JNWCollectionViewTypeSelectIndex alloc] initWithCollectionView:self];
+	}
+	
+	// The first search builds the index, and selects the match for whatever has been typed by then.
+	__weak typeof(self) weakSelf = self;
+	[self.typeSelectIndex buildWithCompletionHandler:^{
+		[weakSelf selectTypeSelectMatch];
+	}];
+	
+	return YES;
+}
+
+- (void)selectTypeSelectMatch {
+	NSIndexPath *indexPath = [self.typeSelectIndex indexPathForPrefix:self.typeSelectString];
+	if (indexPath == nil)
+		return;
+	
+	[self selectItemAtIndexPath:indexPath atScrollPosition:JNWCollectionViewScrollPositionNearest animated:YES];
+}
+
 // TODO: make these ask the layout for "where's the beginning/end?" in case of non-ltr layouts
 - (void)scrollToBeginningOfDocument:(id)sender {
 	[self.clipView scrollRectToVisible:NSMakeRect(0, 0, 0, 0) animated:self.animatesSelection];
@@ -1580,12 +2643,25 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 }
 
 - (void)reloadItemsAtIndexPaths:(NSArray<NSIndexPath*> *)reloadedIndexPaths {
+	[self.snapshotCache removeSnapshotsForItemsAtIndexPaths:reloadedIndexPaths];
+	
+	// The strings of the reloaded items may have changed.
+	[self.typeSelectIndex invalidate];
+	
+	// Items currently shown from a snapshot need a cell instead.
+	if (self.cellPlaceholders.count > 0) {
+		self.needsLayout = YES;
+	}
+	
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
 	for (NSIndexPath* indexPath in reloadedIndexPaths) {
 		if ([self cellForItemAtIndexPath:indexPath] != nil) {
 			[self removeAndEnqueueCellAtIndexPath:indexPath];
 			[self addCellForIndexPath:indexPath];
 		}
 	}
+	[CATransaction commit];
 }
 
 - (void)performBatchUpdates:(void (^)(void))updates completion:(void (^)(BOOL finished))completion {
@@ -1618,12 +2694,21 @@ static void JNWCollectionViewCommonInit(JNWCollectionView *collectionView) {
 	
 	if (self.isAnimating) {
 		NSLog(@"TODO: multiple simultaneous animations are not supported yet");
+		// The snapshots and the type-select index can't follow changes that aren't applied.
+		[self.snapshotCache removeAllSnapshots];
+		[self.typeSelectIndex invalidate];
 		return;
 	}
 	
 	self.isAnimating = YES;
 	NSArray *insertedIndexPaths = [self.insertedItems sortedArrayUsingSelector:@selector(compare:)];
 	NSArray *deletedIndexPaths = self.deletedItems;
+	[self.snapshotCache shiftSnapshotsForDeletedItemsAtIndexPaths:deletedIndexPaths insertedItemsAtIndexPaths:insertedIndexPaths];
+	
+	// Like the cells, deletions are in the old index paths and insertions in the new ones.
+	[self.typeSelectIndex deleteItemsAtIndexPaths:deletedIndexPaths];
+	[self.typeSelectIndex insertItemsAtIndexPaths:insertedIndexPaths];
+	[self.collectionViewLayout willUpdateItemsDeletingItemsAtIndexPaths:deletedIndexPaths insertingItemsAtIndexPaths:insertedIndexPaths];
 	
 	// TODO: Use IndexSet?
 	NSIndexPath*(^existingIndexPathMapping)(NSIndexPath*) = ^NSIndexPath*(NSIndexPath* oldIndexPath) {
@@ -82,4 +82,10 @@ extern NSString * const JNWCollectionViewGridLayoutFooterKind;
 /// Defaults to 0
 @property (nonatomic, assign) CGFloat itemHorizontalMargin;
 
+/// If enabled, the headers will stick to the top of the visible area while
+/// the section is still visible.
+///
+/// Defaults to NO.
+@property (nonatomic, assign) BOOL stickyHeaders;
+
 @end
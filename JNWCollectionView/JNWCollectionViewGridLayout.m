@@ -18,11 +18,21 @@
  */
 
 #import "JNWCollectionViewGridLayout.h"
+#import "JNWCollectionViewLayout+Private.h"
+#import "JNWCollectionViewSectionOffsets.h"
 
 typedef struct {
 	CGPoint origin;
 } JNWCollectionViewGridLayoutItemInfo;
 
+typedef struct {
+	CGSize itemSize;
+	NSUInteger numberOfColumns;
+	CGFloat itemPadding;
+	CGFloat left;
+	JNWCollectionViewGridLayoutItemInfo *itemInfo;
+} JNWCollectionViewGridLayoutSectionMetrics;
+
 NSString * const JNWCollectionViewGridLayoutHeaderKind = @"JNWCollectionViewGridLayoutHeader";
 NSString * const JNWCollectionViewGridLayoutFooterKind = @"JNWCollectionViewGridLayoutFooter";
 
@@ -32,10 +42,15 @@ NSString * const JNWCollectionViewGridLayoutFooterKind = @"JNWCollectionViewGrid
 
 @interface JNWCollectionViewGridLayoutSection : NSObject
 - (instancetype)initWithNumberOfItems:(NSInteger)numberOfItems;
-@property (nonatomic, assign) CGFloat offset;
-@property (nonatomic, assign) CGFloat height;
+@property (nonatomic, unsafe_unretained) JNWCollectionViewSectionOffsets *sectionOffsets;
+@property (nonatomic, assign, readonly) CGFloat start; // the top of the section, looked up in the section offsets
+@property (nonatomic, assign, readonly) CGFloat offset; // the top of the items
+@property (nonatomic, assign, readonly) CGFloat visibleHeight; // the height of the whole section as displayed
+@property (nonatomic, assign) CGFloat height; // the height of the items
+@property (nonatomic, assign) BOOL collapsed;
 @property (nonatomic, assign) CGFloat headerHeight;
 @property (nonatomic, assign) CGFloat footerHeight;
+@property (nonatomic, assign) NSEdgeInsets insets;
 @property (nonatomic, assign) NSInteger index;
 @property (nonatomic, assign) NSInteger numberOfItems;
 @property (nonatomic, assign) JNWCollectionViewGridLayoutItemInfo *itemInfo;
@@ -56,12 +71,27 @@ NSString * const JNWCollectionViewGridLayoutFooterKind = @"JNWCollectionViewGrid
 		free(_itemInfo);
 }
 
+- (CGFloat)start {
+	return [self.sectionOffsets offsetOfSection:self.index];
+}
+
+- (CGFloat)offset {
+	return self.start + self.headerHeight + self.insets.top;
+}
+
+- (CGFloat)visibleHeight {
+	// Collapsed sections only show their header, which sits below the top inset.
+	CGFloat headerHeight = self.insets.top + self.headerHeight;
+	return (self.collapsed ? headerHeight : headerHeight + self.height + self.insets.bottom + self.footerHeight);
+}
+
 @end
 
 static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.f };
 
 @interface JNWCollectionViewGridLayout()
 @property (nonatomic, strong) NSMutableArray *sections;
+@property (nonatomic, strong) JNWCollectionViewSectionOffsets *sectionOffsets;
 @property (nonatomic) NSArray<NSNumber*> *numberOfColumnsList; // NSUInteger
 @property (nonatomic) NSArray<NSNumber*> *itemPaddingList; // CGFloat
 @property (nonatomic, strong) JNWCollectionViewLayoutAttributes *markerAttributes;
@@ -113,37 +143,13 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 	}
     
     NSUInteger numberOfSections = [self.collectionView numberOfSections];
-    CGFloat totalWidth = self.collectionView.visibleSize.width - self.itemHorizontalMargin;
     
+    NSMutableArray *allSizes = [NSMutableArray array];
     if ([self.delegate respondsToSelector:@selector(sizeForItemInCollectionView:forSection:)]) {
-        NSMutableArray *allSizes = [NSMutableArray array];
-        NSMutableArray *allColumnNumbers = [NSMutableArray array];
-        NSMutableArray *addItemPaddings = [NSMutableArray array];
         for (NSUInteger i = 0; i < numberOfSections; i++) {
             CGSize size = [self.delegate sizeForItemInCollectionView:self.collectionView forSection:i];
             [allSizes addObject:[NSValue valueWithSize:size]];
-            // calc # of columns
-            NSUInteger numberOfColumns = totalWidth / (size.width + self.itemHorizontalMargin);
-            if (numberOfColumns == 0) {
-                numberOfColumns = 1;
-            }
-            [allColumnNumbers addObject:[NSNumber numberWithUnsignedInteger:numberOfColumns]];
-            // calc item padding
-            if (self.itemHorizontalMargin == 0 && self.itemPaddingEnabled) {
-                CGFloat totalPadding = totalWidth - (numberOfColumns * size.width);
-                if (totalPadding < 0) {
-                    totalPadding = 0;
-                }
-                totalPadding = floorf(totalPadding / (numberOfColumns + 1));
-                [addItemPaddings addObject:[NSNumber numberWithFloat:totalPadding]];
-            } else {
-                [addItemPaddings addObject:[NSNumber numberWithFloat:self.itemHorizontalMargin]];
-            }
-            
         }
-        self.itemSizes = allSizes;
-        self.numberOfColumnsList = allColumnNumbers;
-        self.itemPaddingList = addItemPaddings;
     }
     else {
         CGSize itemSize = JNWCollectionViewGridLayoutDefaultSize;
@@ -153,38 +159,16 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
         else if (self.itemSize.width != itemSize.width || self.itemSize.height != itemSize.height) {
             itemSize = self.itemSize;
         }
-        NSUInteger numberOfColumns = totalWidth / (itemSize.width + self.itemHorizontalMargin);
-        if (numberOfColumns == 0) {
-            numberOfColumns = 1;
-        }
-        CGFloat padding = self.itemHorizontalMargin;
-        if (self.itemHorizontalMargin == 0 && self.itemPaddingEnabled) {
-            padding = totalWidth - (numberOfColumns * itemSize.width);
-            if (padding < 0) {
-                padding = 0;
-            }
-            padding = floorf(padding / (numberOfColumns + 1));
-        }
-        NSMutableArray *allSizes = [NSMutableArray array];
-        NSMutableArray *allColumnNumbers = [NSMutableArray array];
-        NSMutableArray *addItemPaddings = [NSMutableArray array];
         for (NSUInteger i = 0; i < numberOfSections; i++) {
             [allSizes addObject:[NSValue valueWithSize:itemSize]];
-            [allColumnNumbers addObject:[NSNumber numberWithUnsignedInteger:numberOfColumns]];
-            [addItemPaddings addObject:[NSNumber numberWithUnsignedInteger:padding]];
         }
-        self.itemSizes = allSizes;
-        self.numberOfColumnsList = allColumnNumbers;
-        self.itemPaddingList = addItemPaddings;
     }
+    self.itemSizes = allSizes;
 	
 	BOOL delegateHeightForHeader = [self.delegate respondsToSelector:@selector(collectionView:heightForHeaderInSection:)];
 	BOOL delegateHeightForFooter = [self.delegate respondsToSelector:@selector(collectionView:heightForFooterInSection:)];
 	BOOL delegateForSectionInsets = [self.delegate respondsToSelector:@selector(collectionView:layout:insetForSectionAtIndex:)];
 	
-    CGFloat verticalSpacing = self.verticalSpacing;
-	
-	CGFloat totalHeight = 0;
 	for (NSUInteger section = 0; section < numberOfSections; section++) {
 		NSInteger numberOfItems = [self.collectionView numberOfItemsInSection:section];
 		NSInteger headerHeight = delegateHeightForHeader ? [self.delegate collectionView:self.collectionView heightForHeaderInSection:section] : 0;
@@ -192,54 +176,145 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 		NSEdgeInsets sectionInsets = delegateForSectionInsets ? [self.delegate collectionView:self.collectionView layout:self insetForSectionAtIndex:section] : NSEdgeInsetsMake(0, 0, 0, 0);
 
 		JNWCollectionViewGridLayoutSection *sectionInfo = [[JNWCollectionViewGridLayoutSection alloc] initWithNumberOfItems:numberOfItems];
-		sectionInfo.offset = totalHeight + headerHeight + sectionInsets.top;
-		sectionInfo.height = 0;
 		sectionInfo.index = section;
 		sectionInfo.headerHeight = headerHeight;
 		sectionInfo.footerHeight = footerHeight;
+		sectionInfo.insets = sectionInsets;
+		[self.sections addObject:sectionInfo];
+	}
+	
+	[self layoutSectionsForWidth:self.collectionView.visibleSize.width];
+}
+
+- (BOOL)prepareLayoutForLiveResize {
+	JNWCollectionView *collectionView = self.collectionView;
+	if (self.sections.count != (NSUInteger)[collectionView numberOfSections] || self.itemSizes.count < self.sections.count)
+		return NO;
+	
+	for (JNWCollectionViewGridLayoutSection *sectionInfo in self.sections) {
+		if (sectionInfo.numberOfItems != [collectionView numberOfItemsInSection:sectionInfo.index])
+			return NO;
+	}
+	
+	// The item sizes, header and footer heights and insets are kept from the last preparation,
+	// so only the columns and the positions which depend on them are recalculated.
+	[self layoutSectionsForWidth:collectionView.visibleSize.width];
+	return YES;
+}
+
+/// Calculates the number of columns and the padding of each section for the width, followed by
+/// the positions of the sections and their items. Only depends on the cached section information.
+- (void)layoutSectionsForWidth:(CGFloat)width {
+    NSUInteger numberOfSections = self.sections.count;
+    CGFloat totalWidth = width - self.itemHorizontalMargin;
+    
+    NSMutableArray *allColumnNumbers = [NSMutableArray array];
+    NSMutableArray *addItemPaddings = [NSMutableArray array];
+    for (NSUInteger i = 0; i < numberOfSections; i++) {
+        CGSize size = [self.itemSizes[i] sizeValue];
+        // calc # of columns
+        NSUInteger numberOfColumns = totalWidth / (size.width + self.itemHorizontalMargin);
+        if (numberOfColumns == 0) {
+            numberOfColumns = 1;
+        }
+        [allColumnNumbers addObject:[NSNumber numberWithUnsignedInteger:numberOfColumns]];
+        // calc item padding
+        if (self.itemHorizontalMargin == 0 && self.itemPaddingEnabled) {
+            CGFloat totalPadding = totalWidth - (numberOfColumns * size.width);
+            if (totalPadding < 0) {
+                totalPadding = 0;
+            }
+            totalPadding = floorf(totalPadding / (numberOfColumns + 1));
+            [addItemPaddings addObject:[NSNumber numberWithFloat:totalPadding]];
+        } else {
+            [addItemPaddings addObject:[NSNumber numberWithFloat:self.itemHorizontalMargin]];
+        }
+    }
+    self.numberOfColumnsList = allColumnNumbers;
+    self.itemPaddingList = addItemPaddings;
+	
+    CGFloat verticalSpacing = self.verticalSpacing;
+	
+	// The item origins only depend on constants of their own section, so they are filled in
+	// afterwards, in parallel for large grids.
+	NSMutableData *numberOfItemsData = [NSMutableData dataWithLength:numberOfSections * sizeof(NSInteger)];
+	NSMutableData *metricsData = [NSMutableData dataWithLength:numberOfSections * sizeof(JNWCollectionViewGridLayoutSectionMetrics)];
+	NSInteger *numberOfItemsInSection = numberOfItemsData.mutableBytes;
+	JNWCollectionViewGridLayoutSectionMetrics *metrics = metricsData.mutableBytes;
+	
+	for (NSUInteger section = 0; section < numberOfSections; section++) {
+		JNWCollectionViewGridLayoutSection *sectionInfo = self.sections[section];
+		NSInteger numberOfItems = sectionInfo.numberOfItems;
+		NSEdgeInsets sectionInsets = sectionInfo.insets;
         
         CGSize itemSize = [self.itemSizes[section] sizeValue];
         NSUInteger numberOfColumns = [self.numberOfColumnsList[section] unsignedIntegerValue];
         CGFloat itemPadding = [self.itemPaddingList[section] floatValue];
 		
-		for (NSInteger item = 0; item < numberOfItems; item++) {
-			CGPoint origin = CGPointZero;
-			NSInteger column = ((item - (item % numberOfColumns)) / numberOfColumns);
-			origin.x = sectionInsets.left + itemPadding + (item % numberOfColumns) * (itemSize.width + itemPadding);
-			origin.y = column * itemSize.height + column * verticalSpacing;
-			sectionInfo.itemInfo[item].origin = origin;
-		}
+		numberOfItemsInSection[section] = numberOfItems;
+		metrics[section] = (JNWCollectionViewGridLayoutSectionMetrics){ itemSize, numberOfColumns, itemPadding, sectionInsets.left, sectionInfo.itemInfo };
 		
 		NSInteger numberOfRows = ceilf((float)numberOfItems / (float)numberOfColumns);
 		
 		sectionInfo.height = itemSize.height * numberOfRows + verticalSpacing * MAX(numberOfRows - 1, 0);
-		totalHeight += sectionInfo.height + footerHeight + headerHeight + sectionInsets.bottom + sectionInsets.top;
-		[self.sections addObject:sectionInfo];
 	}
-    
-    if (self.collectionView.dragContext.dropPath) {
-        JNWCollectionViewDropIndexPath *indexPath = self.collectionView.dragContext.dropPath;
-        JNWCollectionViewLayoutAttributes *attributes = [self layoutAttributesForItemAtIndexPath:indexPath];
-        CGRect frame = attributes.frame;
-        if (indexPath.jnw_relation == JNWCollectionViewDropRelationAfter) {
-			frame.origin.x += frame.size.width + 2; // make it appear "after" the dragged-over item
-			NSInteger numberOfRowsForFinalSection = [self.collectionView numberOfItemsInSection:self.sections.count - 1];
-			// If not dragging to the very last item in the very last section, account for vertical spacing
-			if (indexPath.jnw_section != self.sections.count - 1 || indexPath.jnw_item != numberOfRowsForFinalSection - 1) {
-				frame.origin.x += (self.itemHorizontalMargin / 2);
-			}
-        }
-		else {
-			// If not dragging to before the first item, take out vertical spacing
-			if (indexPath.jnw_section != 0 || indexPath.jnw_item != 0)
-				frame.origin.x -= (self.itemHorizontalMargin / 2);
+	
+	[self prepareSectionOffsets];
+	
+	JNWCollectionViewLayoutEnumerateItemRanges(numberOfItemsInSection, numberOfSections, YES, ^(NSInteger section, NSRange items) {
+		JNWCollectionViewGridLayoutSectionMetrics sectionMetrics = metrics[section];
+		for (NSUInteger item = items.location; item < NSMaxRange(items); item++) {
+			CGPoint origin = CGPointZero;
+			NSInteger column = ((item - (item % sectionMetrics.numberOfColumns)) / sectionMetrics.numberOfColumns);
+			origin.x = sectionMetrics.left + sectionMetrics.itemPadding + (item % sectionMetrics.numberOfColumns) * (sectionMetrics.itemSize.width + sectionMetrics.itemPadding);
+			origin.y = column * sectionMetrics.itemSize.height + column * verticalSpacing;
+			sectionMetrics.itemInfo[item].origin = origin;
 		}
-        frame.size.width = 2;
-        attributes.frame = frame;
-        self.markerAttributes = attributes;
-    } else {
-        self.markerAttributes = nil;
-    }
+	});
+	
+	[self prepareDropMarker];
+}
+
+/// Stacks the sections on top of each other, taking into account which sections are collapsed.
+- (void)prepareSectionOffsets {
+	NSUInteger numberOfSections = self.sections.count;
+	NSMutableData *heightsData = [NSMutableData dataWithLength:numberOfSections * sizeof(CGFloat)];
+	CGFloat *heights = heightsData.mutableBytes;
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		JNWCollectionViewGridLayoutSection *sectionInfo = self.sections[sectionIdx];
+		sectionInfo.collapsed = [self isSectionCollapsed:sectionIdx];
+		heights[sectionIdx] = sectionInfo.visibleHeight;
+	}
+	
+	self.sectionOffsets = [[JNWCollectionViewSectionOffsets alloc] initWithHeights:heights count:numberOfSections];
+	for (JNWCollectionViewGridLayoutSection *sectionInfo in self.sections) {
+		sectionInfo.sectionOffsets = self.sectionOffsets;
+	}
+}
+
+- (BOOL)updateLayoutForCollapsedSectionsChangedAtIndexes:(NSIndexSet *)sections {
+	NSUInteger numberOfSections = self.sections.count;
+	
+	// Each section is moved in the offsets individually, unless so many sections change at once
+	// that restacking all of them is cheaper.
+	if (sections.count > numberOfSections / 8) {
+		[self prepareSectionOffsets];
+	} else {
+		[sections enumerateIndexesUsingBlock:^(NSUInteger sectionIdx, BOOL *stop) {
+			if (sectionIdx >= numberOfSections) {
+				*stop = YES;
+				return;
+			}
+			
+			JNWCollectionViewGridLayoutSection *sectionInfo = self.sections[sectionIdx];
+			sectionInfo.collapsed = [self isSectionCollapsed:sectionIdx];
+			[self.sectionOffsets setHeight:sectionInfo.visibleHeight ofSection:sectionIdx];
+		}];
+	}
+	
+	[self prepareDropMarker];
+	return YES;
 }
 
 - (CGSize)sizeForSection:(NSUInteger)section {
@@ -259,38 +334,121 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 	
 	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
     CGSize size = [self sizeForSection:indexPath.jnw_section];
+	if (section.collapsed) {
+		// Items of a collapsed section are folded up underneath the header.
+		attributes.frame = CGRectMake(itemInfo.origin.x, section.start + section.visibleHeight, size.width, 0);
+		attributes.alpha = 0.f;
+		return attributes;
+	}
+	
 	attributes.frame = CGRectMake(itemInfo.origin.x, itemInfo.origin.y + offset, size.width, size.height);
 	attributes.alpha = 1.f;
 	return attributes;
 }
 
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForSupplementaryItemInSection:(NSInteger)idx kind:(NSString *)kind {
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = [self rectForSupplementaryItemInSection:idx kind:kind];
+	attributes.alpha = 1.f;
+	attributes.zIndex = NSIntegerMax;
+	return attributes;
+}
+
+- (CGRect)rectForSupplementaryItemInSection:(NSInteger)idx kind:(NSString *)kind {
 	JNWCollectionViewGridLayoutSection *section = self.sections[idx];
 	CGFloat width = self.collectionView.visibleSize.width;
 	CGRect frame = CGRectZero;
 	
 	if ([kind isEqualToString:JNWCollectionViewGridLayoutHeaderKind]) {
 		frame = CGRectMake(0, section.offset - section.headerHeight, width, section.headerHeight);
+		
+		if (self.stickyHeaders) {
+			CGPoint contentOffset = self.collectionView.documentVisibleRect.origin;
+			CGFloat nextHeaderOffset = FLT_MAX;
+			
+			if (idx + 1 < self.sections.count) {
+				JNWCollectionViewGridLayoutSection *nextSection = self.sections[idx + 1];
+				nextHeaderOffset = nextSection.offset - nextSection.headerHeight;
+			}
+			
+			frame.origin.y = MIN(MAX(contentOffset.y, frame.origin.y), nextHeaderOffset - CGRectGetHeight(frame));
+		}
 	} else if ([kind isEqualToString:JNWCollectionViewGridLayoutFooterKind]) {
-		frame = CGRectMake(0, section.offset + section.height, width, section.footerHeight);
+		if (section.collapsed) {
+			// The footer of a collapsed section is tucked away underneath its header.
+			frame = CGRectMake(0, section.start + section.visibleHeight, width, 0);
+		} else {
+			frame = CGRectMake(0, section.offset + section.height, width, section.footerHeight);
+		}
 	}
 	
-	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
-	attributes.frame = frame;
-	attributes.alpha = 1.f;
-	return attributes;
+	return frame;
+}
+
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	NSMutableDictionary *indexesByKind = [NSMutableDictionary dictionary];
+	if (self.sections.count == 0)
+		return indexesByKind;
+	
+	// The header of a section can only intersect the rect if the items of the previous section
+	// start above the top of the rect, so the search can begin at that section.
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSString *kind in kinds) {
+		if (![kind isEqualToString:JNWCollectionViewGridLayoutHeaderKind] && ![kind isEqualToString:JNWCollectionViewGridLayoutFooterKind])
+			continue;
+		
+		NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+		for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+			JNWCollectionViewGridLayoutSection *section = self.sections[sectionIdx];
+			if (section.offset - section.headerHeight >= CGRectGetMaxY(rect))
+				break;
+			if (section.collapsed && [kind isEqualToString:JNWCollectionViewGridLayoutFooterKind])
+				continue;
+			
+			if (CGRectIntersectsRect([self rectForSupplementaryItemInSection:sectionIdx kind:kind], rect)) {
+				[indexes addIndex:sectionIdx];
+			}
+		}
+		
+		if (indexes.count > 0) {
+			indexesByKind[kind] = indexes;
+		}
+	}
+	
+	return indexesByKind;
+}
+
+- (BOOL)shouldApplyExistingLayoutAttributesOnLayout {
+	return NO;
+}
+
+- (NSArray *)scrollDependentSupplementaryItemKinds {
+	return (self.stickyHeaders ? @[ JNWCollectionViewGridLayoutHeaderKind ] : nil);
 }
 
 - (CGRect)rectForSectionAtIndex:(NSInteger)index {
 	JNWCollectionViewGridLayoutSection *section = self.sections[index];
-	CGFloat height = section.height + section.headerHeight + section.footerHeight;
-	return CGRectMake(0, section.offset, self.collectionView.visibleSize.width, height);
+	return CGRectMake(0, section.start, self.collectionView.visibleSize.width, section.visibleHeight);
 }
 
 - (NSArray *)indexPathsForItemsInRect:(CGRect)rect {
 	NSMutableArray *visibleRows = [NSMutableArray array];
 	
-	for (JNWCollectionViewGridLayoutSection *section in self.sections) {
+	// Only the sections from the one containing the top of the rect down to the bottom of the rect
+	// can have items inside it.
+	NSInteger firstSection = [self.sectionOffsets sectionAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+		JNWCollectionViewGridLayoutSection *section = self.sections[sectionIdx];
+		if (section.start >= CGRectGetMaxY(rect))
+			break;
+		if (section.collapsed)
+			continue;
         
         NSRange columns = [self columnsInRect:rect forSection:section.index];
 		NSRange rows = [self rowsInRect:rect fromSection:section];
@@ -314,8 +472,10 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 	
 	if (direction == JNWCollectionViewDirectionRight) {
 		newIndexPath = [self.collectionView indexPathForNextSelectableItemAfterIndexPath:currentIndexPath];
+		newIndexPath = [self indexPathSkippingCollapsedSections:newIndexPath forward:YES];
 	} else if (direction == JNWCollectionViewDirectionLeft) {
 		newIndexPath = [self.collectionView indexPathForNextSelectableItemBeforeIndexPath:currentIndexPath];
+		newIndexPath = [self indexPathSkippingCollapsedSections:newIndexPath forward:NO];
 	} else if (direction == JNWCollectionViewDirectionUp) {
 		CGPoint origin = [self.collectionView rectForItemAtIndexPath:currentIndexPath].origin;
 		// Bump the origin up to the cell directly above this one.
@@ -344,28 +504,24 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 }
 
 - (NSRange)columnsInRect:(CGRect)rect forSection:(NSUInteger)section {
-	NSRange result = NSMakeRange(0, 0);
+	JNWCollectionViewGridLayoutSection *sectionInfo = self.sections[section];
+	if (sectionInfo.numberOfItems == 0)
+		return NSMakeRange(0, 0);
 	
-	CGPoint point = CGPointMake(0, CGRectGetMinY(rect));
+	// Every column is the same width, so the columns intersecting the rect can be calculated directly.
     CGSize size = [self sizeForSection:section];
-    NSUInteger numberOfColumns = [self.numberOfColumnsList[section] unsignedIntegerValue];
+    NSInteger numberOfColumns = [self.numberOfColumnsList[section] unsignedIntegerValue];
     CGFloat itemPadding = [self.itemPaddingList[section] floatValue];
-	for (NSUInteger column = 0; column < numberOfColumns; column++) {
-		point.x += itemPadding;
-		
-		if (CGRectContainsPoint(rect, point)) {
-			if (result.length == 0) {
-				result = NSMakeRange(column, 1);
-			}
-			else {
-				result.length++;
-			}
-		}
-		
-		point.x += size.width;
-	}
+	CGFloat columnWidth = size.width + itemPadding;
+	CGFloat firstColumnX = sectionInfo.itemInfo[0].origin.x;
+	
+	NSInteger firstColumn = MAX(0, (NSInteger)floor((CGRectGetMinX(rect) - firstColumnX - size.width) / columnWidth) + 1);
+	NSInteger lastColumn = MIN(numberOfColumns - 1, (NSInteger)ceil((CGRectGetMaxX(rect) - firstColumnX) / columnWidth) - 1);
+	
+	if (lastColumn < firstColumn)
+		return NSMakeRange(0, 0);
 	
-	return result;
+	return NSMakeRange(firstColumn, lastColumn - firstColumn + 1);
 }
 
 - (NSRange)rowsInRect:(CGRect)rect fromSection:(JNWCollectionViewGridLayoutSection *)section {
@@ -383,68 +539,96 @@ static const CGSize JNWCollectionViewGridLayoutDefaultSize = (CGSize){ 44.f, 44.
 
 #pragma Drag and Drop
 
+- (void)prepareDropMarker {
+	JNWCollectionViewDropIndexPath *indexPath = self.collectionView.dragContext.dropPath;
+	if (indexPath == nil || indexPath.jnw_section >= self.sections.count ||
+		indexPath.jnw_item >= [self.sections[indexPath.jnw_section] numberOfItems] || [self.sections[indexPath.jnw_section] collapsed]) {
+		self.markerAttributes = nil;
+		return;
+	}
+	
+	JNWCollectionViewLayoutAttributes *attributes = [self layoutAttributesForItemAtIndexPath:indexPath];
+	CGRect frame = attributes.frame;
+	if (indexPath.jnw_relation == JNWCollectionViewDropRelationAfter) {
+		frame.origin.x += frame.size.width + 2; // make it appear "after" the dragged-over item
+		JNWCollectionViewGridLayoutSection *finalSection = self.sections.lastObject;
+		// If not dragging to the very last item in the very last section, account for vertical spacing
+		if (indexPath.jnw_section != finalSection.index || indexPath.jnw_item != finalSection.numberOfItems - 1) {
+			frame.origin.x += (self.itemHorizontalMargin / 2);
+		}
+	}
+	else {
+		// If not dragging to before the first item, take out vertical spacing
+		if (indexPath.jnw_section != 0 || indexPath.jnw_item != 0)
+			frame.origin.x -= (self.itemHorizontalMargin / 2);
+	}
+	frame.size.width = 2;
+	attributes.frame = frame;
+	self.markerAttributes = attributes;
+}
+
 - (JNWCollectionViewDropIndexPath *)dropIndexPathAtPoint:(NSPoint)point {
     [self scrollIfNecessaryForDragAtPoint:point];
-    NSArray *visibleCells = [self.collectionView visibleCells];
-    CGFloat greatestXCoord = 0.0f; // greatest X coordinate for final row
-    CGFloat greatestYCoord = 0.0f;
-    NSUInteger greatestCellIndex = 0;
-    NSUInteger greatestCellSection = 0;
-    for (JNWCollectionViewCell *cell in visibleCells) {
-        NSIndexPath *path = [self.collectionView indexPathForCell:cell];
-        NSUInteger previousGreatestSection = greatestCellSection;
-        greatestCellSection = greatestCellSection > path.jnw_section ? greatestCellSection : path.jnw_section;
-        if (previousGreatestSection < greatestCellSection) {
-            greatestCellIndex = 0;
-        }
-        greatestCellIndex = greatestCellIndex > path.jnw_item ? greatestCellIndex : path.jnw_item;
-        CGFloat previousGreatestYCoord = greatestYCoord;
-        greatestYCoord = greatestYCoord > cell.frame.origin.y ? greatestYCoord : cell.frame.origin.y;
-        if (previousGreatestYCoord < greatestYCoord) {
-            greatestXCoord = 0;
-        }
-        greatestXCoord = greatestXCoord > cell.frame.origin.x + cell.frame.size.width ? greatestXCoord : cell.frame.origin.x + cell.frame.size.width;
-        if (CGRectContainsPoint(cell.frame, point)) {
-            if (path) {
-                if (point.x <= cell.frame.origin.x + cell.frame.size.width * 0.5) {
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:path.jnw_item inSection:path.jnw_section dropRelation:JNWCollectionViewDropRelationAt];
-                } else {
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:path.jnw_item inSection:path.jnw_section dropRelation:JNWCollectionViewDropRelationAfter];
-                }
-            }
-        }
-        else {
-            // We may need to account for horizontal item padding to know which cell is being dropped on
-            NSUInteger numberOfColumns = self.numberOfColumnsList[cell.indexPath.jnw_section].unsignedIntegerValue;
-            NSUInteger positionCalculation = cell.indexPath.jnw_item % numberOfColumns;
-            BOOL isItemOnVeryLeft = positionCalculation == 0;
-            BOOL isItemOnVeryRight = positionCalculation == numberOfColumns;
-            CGRect rectWithSpacing = cell.frame;
-            // see if the drag operation is "between" cells by being "right of" the cell
-            CGFloat halfPadding = self.itemPaddingList[cell.indexPath.jnw_section].floatValue / 2;
-            rectWithSpacing.size.width += halfPadding;
-            if (!isItemOnVeryRight && CGRectContainsPoint(rectWithSpacing, point)) {
-                return [JNWCollectionViewDropIndexPath indexPathForItem:cell.indexPath.jnw_item inSection:cell.indexPath.jnw_section dropRelation:JNWCollectionViewDropRelationAfter];
-            }
-            // see if the drag operation is "between" cells by being "left of" the cell
-            rectWithSpacing = cell.frame;
-            rectWithSpacing.origin.x -= halfPadding;
-            if (!isItemOnVeryLeft && CGRectContainsPoint(rectWithSpacing, point)) {
-                return [JNWCollectionViewDropIndexPath indexPathForItem:cell.indexPath.jnw_item inSection:cell.indexPath.jnw_section dropRelation:JNWCollectionViewDropRelationAt];
-            }
-        }
+    
+    // Find the section with a binary search, then the row and column arithmetically, so that
+    // the cost of a drag update does not depend on the number of visible cells.
+    NSInteger sectionIdx = [self sectionIndexAtOffset:point.y];
+    if (sectionIdx == NSNotFound)
+        return nil;
+    
+    // Points below the items of a section (or inside an empty or collapsed section) drop after
+    // the last item of the closest preceding section with visible items.
+    while (sectionIdx >= 0 && ([self.sections[sectionIdx] numberOfItems] == 0 || [self.sections[sectionIdx] collapsed])) {
+        sectionIdx--;
+    }
+    if (sectionIdx < 0)
+        return nil;
+    
+    JNWCollectionViewGridLayoutSection *section = self.sections[sectionIdx];
+    NSInteger lastItem = section.numberOfItems - 1;
+    CGFloat relativeOffset = point.y - section.offset;
+    if (relativeOffset > section.height) {
+        return [JNWCollectionViewDropIndexPath indexPathForItem:lastItem inSection:section.index dropRelation:JNWCollectionViewDropRelationAfter];
     }
-    // if dragging past all other cells while still in the JNWCollectionView, treat it as though dropping to last position
-    if (point.x > greatestXCoord || point.y > greatestYCoord) {
-        return [JNWCollectionViewDropIndexPath indexPathForItem:greatestCellIndex
-                                                      inSection:greatestCellSection
-                                                   dropRelation:JNWCollectionViewDropRelationAfter];
+    
+    CGSize size = [self sizeForSection:section.index];
+    NSUInteger numberOfColumns = [self.numberOfColumnsList[section.index] unsignedIntegerValue];
+    CGFloat itemPadding = [self.itemPaddingList[section.index] floatValue];
+    CGFloat columnWidth = size.width + itemPadding;
+    CGFloat firstColumnX = section.itemInfo[0].origin.x;
+    
+    NSInteger row = MAX(0, floor(relativeOffset / (size.height + self.verticalSpacing)));
+    // Half of the padding on either side of an item belongs to that item.
+    NSInteger column = floor((point.x - firstColumnX + itemPadding / 2) / columnWidth);
+    column = MIN(MAX(column, 0), (NSInteger)numberOfColumns - 1);
+    
+    NSInteger item = row * numberOfColumns + column;
+    if (item > lastItem) {
+        return [JNWCollectionViewDropIndexPath indexPathForItem:lastItem inSection:section.index dropRelation:JNWCollectionViewDropRelationAfter];
     }
-    return nil;
+    
+    CGFloat itemX = firstColumnX + column * columnWidth;
+    JNWCollectionViewDropRelation relation = (point.x <= itemX + size.width * 0.5 ? JNWCollectionViewDropRelationAt : JNWCollectionViewDropRelationAfter);
+    return [JNWCollectionViewDropIndexPath indexPathForItem:item inSection:section.index dropRelation:relation];
 }
 
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForDropMarker {
     return self.markerAttributes;
 }
 
+/// Returns the index of the last section whose items start at or above the offset, or
+/// NSNotFound if the offset is above the items of the first section.
+- (NSInteger)sectionIndexAtOffset:(CGFloat)offset {
+	NSInteger sectionIdx = [self.sectionOffsets sectionAtOffset:offset];
+	if (sectionIdx == NSNotFound)
+		return NSNotFound;
+	
+	// If the offset is within the header of the section, the items of the section before it are
+	// the last ones to start above it.
+	if ([self.sections[sectionIdx] offset] > offset) {
+		sectionIdx--;
+	}
+	return (sectionIdx >= 0 ? sectionIdx : NSNotFound);
+}
+
 @end
@@ -0,0 +1,45 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewPagedDataSource.h"
+
+/// A paged backend serving objects from an array after a simulated delay, for developing and
+/// testing with a paged data source without a real database or server.
+@interface JNWCollectionViewInMemoryPagedBackend : NSObject <JNWCollectionViewPagedBackend>
+
+- (instancetype)initWithObjects:(NSArray *)objects;
+
+@property (nonatomic, copy, readonly) NSArray *objects;
+
+/// The delay before each page is returned, in seconds.
+///
+/// Defaults to 0.1.
+@property (nonatomic, assign) NSTimeInterval latency;
+
+/// If YES, -estimatedNumberOfObjects is reported as the given estimate rather than the backend
+/// appearing to have no estimate, so that both growing and estimated counts can be exercised.
+///
+/// Defaults to NO.
+@property (nonatomic, assign) BOOL providesEstimatedNumberOfObjects;
+@property (nonatomic, assign) NSUInteger estimatedNumberOfObjects;
+
+/// The number of pages requested so far.
+@property (nonatomic, assign, readonly) NSUInteger numberOfFetches;
+
+@end
@@ -0,0 +1,56 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewInMemoryPagedBackend.h"
+
+@interface JNWCollectionViewInMemoryPagedBackend()
+@property (nonatomic, assign, readwrite) NSUInteger numberOfFetches;
+@end
+
+@implementation JNWCollectionViewInMemoryPagedBackend
+
+- (instancetype)initWithObjects:(NSArray *)objects {
+	self = [super init];
+	if (self == nil) return nil;
+	_objects = [objects copy];
+	_latency = 0.1;
+	_estimatedNumberOfObjects = _objects.count;
+	return self;
+}
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+	// The estimate is optional in the protocol, so it's hidden unless enabled.
+	if (aSelector == @selector(estimatedNumberOfObjects)) {
+		return self.providesEstimatedNumberOfObjects;
+	}
+	return [super respondsToSelector:aSelector];
+}
+
+- (void)fetchObjectsInRange:(NSRange)range completionHandler:(void (^)(NSArray *, NSError *))completionHandler {
+	self.numberOfFetches++;
+	
+	NSArray *objects = self.objects;
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		NSUInteger location = MIN(range.location, objects.count);
+		NSUInteger length = MIN(range.length, objects.count - location);
+		completionHandler([objects subarrayWithRange:NSMakeRange(location, length)], nil);
+	});
+}
+
+@end
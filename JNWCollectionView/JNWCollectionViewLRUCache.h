@@ -0,0 +1,50 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/// A cache which evicts its least recently used objects once their total cost exceeds a limit.
+///
+/// Unlike NSCache, eviction is deterministic and only happens when objects are added or the limit
+/// is lowered, and the objects can be moved to new keys without losing their place in the order.
+@interface JNWCollectionViewLRUCache : NSObject
+
+/// The maximum total cost of the objects held by the cache. Lowering the limit immediately
+/// evicts objects until the cache fits.
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/// The total cost of the objects currently held by the cache.
+@property (nonatomic, assign, readonly) NSUInteger totalCost;
+
+/// Returns the object for the key and marks it as the most recently used, or returns nil.
+- (id)objectForKey:(id)key;
+
+/// Adds the object as the most recently used, replacing any object for the key, then evicts the
+/// least recently used objects until the cache fits.
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost;
+
+- (void)removeObjectForKey:(id)key;
+- (void)removeAllObjects;
+
+/// Moves every object to the key returned by the block for its current key, or removes it if
+/// the block returns nil. The new keys must be distinct.
+- (void)rekeyObjectsUsingBlock:(id<NSCopying> (^)(id key))block;
+
+@end
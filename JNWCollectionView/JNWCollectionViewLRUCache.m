@@ -0,0 +1,178 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+
+#import "JNWCollectionViewLRUCache.h"
+
+// An object in the cache, linked into the recently-used list.
+@interface JNWLRUCacheNode : NSObject
+@property (nonatomic, copy) id key;
+@property (nonatomic, strong) id object;
+@property (nonatomic, assign) NSUInteger cost;
+@property (nonatomic, weak) JNWLRUCacheNode *previous;
+@property (nonatomic, strong) JNWLRUCacheNode *next;
+@end
+
+@implementation JNWLRUCacheNode
+@end
+
+@interface JNWCollectionViewLRUCache()
+@property (nonatomic, strong) NSMutableDictionary *nodes;
+@property (nonatomic, strong) JNWLRUCacheNode *mostRecentNode;
+@property (nonatomic, weak) JNWLRUCacheNode *leastRecentNode;
+@property (nonatomic, assign, readwrite) NSUInteger totalCost;
+@end
+
+@implementation JNWCollectionViewLRUCache
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_totalCostLimit = NSUIntegerMax;
+	_nodes = [NSMutableDictionary dictionary];
+	
+	return self;
+}
+
+- (void)dealloc {
+	[self removeAllObjects];
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+	_totalCostLimit = totalCostLimit;
+	[self evictObjectsToFitCostLimit];
+}
+
+#pragma mark Objects
+
+- (id)objectForKey:(id)key {
+	JNWLRUCacheNode *node = self.nodes[key];
+	if (node == nil)
+		return nil;
+	
+	[self markNodeAsMostRecent:node];
+	return node.object;
+}
+
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost {
+	NSParameterAssert(object != nil);
+	NSParameterAssert(key != nil);
+	
+	[self removeObjectForKey:key];
+	
+	JNWLRUCacheNode *node = [[JNWLRUCacheNode alloc] init];
+	node.key = key;
+	node.object = object;
+	node.cost = cost;
+	
+	self.nodes[key] = node;
+	self.totalCost += cost;
+	[self insertNodeAsMostRecent:node];
+	
+	[self evictObjectsToFitCostLimit];
+}
+
+- (void)removeObjectForKey:(id)key {
+	JNWLRUCacheNode *node = self.nodes[key];
+	if (node != nil) {
+		[self removeNode:node];
+	}
+}
+
+- (void)removeAllObjects {
+	// Unlink the list one node at a time, as releasing a long chain of strong
+	// references at once could recurse deeply.
+	while (self.leastRecentNode != nil) {
+		[self removeNode:self.leastRecentNode];
+	}
+}
+
+- (void)rekeyObjectsUsingBlock:(id<NSCopying> (^)(id key))block {
+	NSMutableDictionary *nodes = [NSMutableDictionary dictionaryWithCapacity:self.nodes.count];
+	for (JNWLRUCacheNode *node in self.nodes.allValues) {
+		id<NSCopying> key = block(node.key);
+		if (key == nil) {
+			[self unlinkNode:node];
+			self.totalCost -= node.cost;
+			continue;
+		}
+		
+		node.key = key;
+		nodes[key] = node;
+	}
+	self.nodes = nodes;
+}
+
+#pragma mark List
+
+- (void)evictObjectsToFitCostLimit {
+	while (self.totalCost > self.totalCostLimit && self.leastRecentNode != nil) {
+		[self removeNode:self.leastRecentNode];
+	}
+}
+
+- (void)removeNode:(JNWLRUCacheNode *)node {
+	[self unlinkNode:node];
+	[self.nodes removeObjectForKey:node.key];
+	self.totalCost -= node.cost;
+}
+
+- (void)markNodeAsMostRecent:(JNWLRUCacheNode *)node {
+	if (node == self.mostRecentNode)
+		return;
+	
+	[self unlinkNode:node];
+	[self insertNodeAsMostRecent:node];
+}
+
+- (void)insertNodeAsMostRecent:(JNWLRUCacheNode *)node {
+	node.previous = nil;
+	node.next = self.mostRecentNode;
+	self.mostRecentNode.previous = node;
+	self.mostRecentNode = node;
+	
+	if (self.leastRecentNode == nil) {
+		self.leastRecentNode = node;
+	}
+}
+
+- (void)unlinkNode:(JNWLRUCacheNode *)node {
+	// Keep the node alive while the neighbouring links are rewritten.
+	JNWLRUCacheNode *strongNode = node;
+	JNWLRUCacheNode *previous = strongNode.previous;
+	JNWLRUCacheNode *next = strongNode.next;
+	
+	if (previous != nil) {
+		previous.next = next;
+	} else if (self.mostRecentNode == strongNode) {
+		self.mostRecentNode = next;
+	}
+	
+	if (next != nil) {
+		next.previous = previous;
+	} else if (self.leastRecentNode == strongNode) {
+		self.leastRecentNode = previous;
+	}
+	
+	strongNode.previous = nil;
+	strongNode.next = nil;
+}
+
+@end
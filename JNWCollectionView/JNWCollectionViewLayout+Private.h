@@ -22,4 +22,17 @@
 @class JNWCollectionView;
 @interface JNWCollectionViewLayout ()
 @property (nonatomic, weak, readwrite) JNWCollectionView *collectionView;
+
+/// Moves an index path in a collapsed section past the section, to the first item after it or
+/// the last item before it. Returns nil if there is no such item.
+- (NSIndexPath *)indexPathSkippingCollapsedSections:(NSIndexPath *)indexPath forward:(BOOL)forward;
 @end
+
+/// Calls the block with consecutive ranges of the items in every section, splitting large
+/// sections into several ranges.
+///
+/// If `concurrently` is YES and there are enough items to make it worthwhile, the ranges are
+/// processed in parallel on a global queue, and the block must be safe to call from any thread.
+/// Otherwise the ranges are processed in order on the calling thread. Returns once all ranges
+/// have been processed.
+extern void JNWCollectionViewLayoutEnumerateItemRanges(const NSInteger *numberOfItems, NSInteger numberOfSections, BOOL concurrently, void (^block)(NSInteger section, NSRange items));
@@ -84,6 +84,25 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollDirection) {
 /// invalidation behavior.
 - (void)prepareLayout;
 
+/// Called instead of -prepareLayout when the layout is invalidated while the collection view
+/// is being resized live. The number of sections and items has not changed since the layout
+/// was last prepared.
+///
+/// Subclasses can override this method to recalculate only the geometry that depends on the
+/// size of the collection view, reusing what was cached from the delegate, and return YES.
+/// The layout is fully prepared once again when the resize ends.
+///
+/// The default implementation returns NO, in which case -prepareLayout is called instead.
+- (BOOL)prepareLayoutForLiveResize;
+
+/// Called before the layout is prepared for items which have been deleted and inserted through
+/// the collection view. The deleted index paths are those before the update, and the inserted
+/// index paths those after it.
+///
+/// Subclasses that cache per-item information can override this method to keep what is known
+/// about the items which haven't changed. The default implementation does nothing.
+- (void)willUpdateItemsDeletingItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertingItemsAtIndexPaths:(NSArray *)insertedIndexPaths;
+
 /// Subclasses should override these methods (if applicable) to return the layout attributes
 /// for the item at the specified index path, or the supplementary item for the specified
 /// section and kind.
@@ -103,6 +122,17 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollDirection) {
 /// Default return value is nil.
 - (NSArray *)indexPathsForItemsInRect:(CGRect)rect;
 
+/// Subclasses should return the sections whose supplementary items intersect the specified rect,
+/// as a dictionary keyed by supplementary view kind with an index set of sections as the value.
+/// Only the kinds passed in need to be considered, and kinds without any intersecting
+/// sections may be omitted.
+///
+/// Implementing this method avoids querying the attributes of every supplementary item in every
+/// section during each layout pass, which is expensive for a large number of sections.
+///
+/// Default return value is nil.
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect;
+
 /// Subclasses should override this method to return the size of the specified section.
 ///
 /// Overriding this method significantly decreases the time taken to recalculate layout
@@ -152,6 +182,43 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollDirection) {
 /// The default return value is NO, for performance reasons.
 - (BOOL)shouldApplyExistingLayoutAttributesOnLayout;
 
+/// Subclasses can override this method to return the supplementary view kinds whose layout
+/// attributes depend on the scroll position, such as pinned headers.
+///
+/// On every layout pass the collection view will re-apply the attributes of the visible
+/// supplementary views of these kinds, without re-applying the attributes of any other
+/// visible cells or views. This is far cheaper than returning YES from
+/// -shouldApplyExistingLayoutAttributesOnLayout when only a few views move while scrolling.
+///
+/// The default return value is nil.
+- (NSArray *)scrollDependentSupplementaryItemKinds;
+
+#pragma mark Collapsible Sections
+
+/// Whether the items of the section are hidden, leaving only its header in place.
+- (BOOL)isSectionCollapsed:(NSInteger)section;
+
+/// Collapses or expands the section, moving the sections after it up or down. If animated, the
+/// visible cells move to their new positions, and cells that appear or disappear fade in or out.
+///
+/// The collapsed state belongs to the layout, and is kept across reloads. It only has an effect in
+/// layouts which support collapsing, such as the list and grid layouts.
+- (void)setSection:(NSInteger)section collapsed:(BOOL)collapsed animated:(BOOL)animated;
+
+/// Collapses or expands all sections in the collection view.
+- (void)setAllSectionsCollapsed:(BOOL)collapsed animated:(BOOL)animated;
+
+/// The indexes of the collapsed sections.
+@property (nonatomic, copy, readonly) NSIndexSet *collapsedSections;
+
+/// Called after the sections have been collapsed or expanded.
+///
+/// Subclasses which support collapsing should update their geometry for the new state and return
+/// YES, in which case the collection view updates its cells without the layout being prepared
+/// again. Subclasses should not call super. The default implementation returns NO, which
+/// invalidates the layout instead.
+- (BOOL)updateLayoutForCollapsedSectionsChangedAtIndexes:(NSIndexSet *)sections;
+
 #pragma mark Drag and Drop
 
 /// Subclasses should return the index path for a drop operation at the specified point, or nil
@@ -164,6 +231,14 @@ typedef NS_ENUM(NSInteger, JNWCollectionViewScrollDirection) {
 /// The height of the returned frame should be 1.
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForDropMarker;
 
+/// Called whenever the drop index path of the current drag and drop session changes.
+///
+/// Subclasses that support drop markers should calculate the attributes returned from
+/// -layoutAttributesForDropMarker here, using the geometry cached in -prepareLayout.
+/// This is called for every change of the drop location, so it should not recalculate
+/// anything other than the marker itself.
+- (void)prepareDropMarker;
+
 /// Attempts to scroll the collection view up, down, left, or right depending on the given point.
 ///
 /// Returns YES if the view was scrolled and NO if it was not.
@@ -25,6 +25,51 @@
 
 @end
 
+// Large enough that the overhead of dispatching a range is small compared to the work in it.
+static const NSInteger JNWCollectionViewLayoutItemsPerRange = 4096;
+
+typedef struct {
+	NSInteger section;
+	NSRange items;
+} JNWCollectionViewLayoutItemRange;
+
+void JNWCollectionViewLayoutEnumerateItemRanges(const NSInteger *numberOfItems, NSInteger numberOfSections, BOOL concurrently, void (^block)(NSInteger section, NSRange items)) {
+	NSInteger totalNumberOfItems = 0;
+	for (NSInteger section = 0; section < numberOfSections; section++) {
+		totalNumberOfItems += numberOfItems[section];
+	}
+	
+	if (!concurrently || totalNumberOfItems <= JNWCollectionViewLayoutItemsPerRange) {
+		for (NSInteger section = 0; section < numberOfSections; section++) {
+			if (numberOfItems[section] > 0) {
+				block(section, NSMakeRange(0, numberOfItems[section]));
+			}
+		}
+		return;
+	}
+	
+	// Small sections become a range each, and large sections are split up, so that the
+	// work is spread evenly across the processors.
+	NSMutableData *rangesData = [NSMutableData data];
+	for (NSInteger section = 0; section < numberOfSections; section++) {
+		for (NSInteger item = 0; item < numberOfItems[section]; item += JNWCollectionViewLayoutItemsPerRange) {
+			JNWCollectionViewLayoutItemRange range = { section, NSMakeRange(item, MIN(JNWCollectionViewLayoutItemsPerRange, numberOfItems[section] - item)) };
+			[rangesData appendBytes:&range length:sizeof(range)];
+		}
+	}
+	
+	const JNWCollectionViewLayoutItemRange *ranges = rangesData.bytes;
+	dispatch_apply(rangesData.length / sizeof(JNWCollectionViewLayoutItemRange), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t idx) {
+		@autoreleasepool {
+			block(ranges[idx].section, ranges[idx].items);
+		}
+	});
+}
+
+@interface JNWCollectionViewLayout ()
+@property (nonatomic, strong) NSMutableIndexSet *mutableCollapsedSections;
+@end
+
 @implementation JNWCollectionViewLayout
 
 - (instancetype)init {
@@ -56,6 +101,14 @@
 	// For subclasses
 }
 
+- (BOOL)prepareLayoutForLiveResize {
+	return NO;
+}
+
+- (void)willUpdateItemsDeletingItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertingItemsAtIndexPaths:(NSArray *)insertedIndexPaths {
+	// Subclasses can override this to keep information about unchanged items.
+}
+
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
 	return nil;
 }
@@ -68,6 +121,10 @@
 	return nil;
 }
 
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	return nil;
+}
+
 - (CGRect)rectForSectionAtIndex:(NSInteger)index {
 	return CGRectNull;
 }
@@ -92,6 +149,90 @@
 	return YES;
 }
 
+- (NSArray *)scrollDependentSupplementaryItemKinds {
+	return nil;
+}
+
+#pragma mark Collapsible Sections
+
+- (NSIndexSet *)collapsedSections {
+	return [self.mutableCollapsedSections copy];
+}
+
+- (NSMutableIndexSet *)mutableCollapsedSections {
+	if (_mutableCollapsedSections == nil) {
+		_mutableCollapsedSections = [NSMutableIndexSet indexSet];
+	}
+	return _mutableCollapsedSections;
+}
+
+- (BOOL)isSectionCollapsed:(NSInteger)section {
+	return [_mutableCollapsedSections containsIndex:section];
+}
+
+- (void)setSection:(NSInteger)section collapsed:(BOOL)collapsed animated:(BOOL)animated {
+	NSParameterAssert(section >= 0);
+	if ([self isSectionCollapsed:section] == collapsed)
+		return;
+	
+	[self setSections:[NSIndexSet indexSetWithIndex:section] collapsed:collapsed animated:animated];
+}
+
+- (void)setAllSectionsCollapsed:(BOOL)collapsed animated:(BOOL)animated {
+	NSMutableIndexSet *sections = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.collectionView.numberOfSections)];
+	if (collapsed) {
+		[sections removeIndexes:self.mutableCollapsedSections];
+	} else {
+		// Sections beyond the current number of sections are forgotten as well.
+		sections = [self.mutableCollapsedSections mutableCopy];
+	}
+	
+	if (sections.count > 0) {
+		[self setSections:sections collapsed:collapsed animated:animated];
+	}
+}
+
+- (void)setSections:(NSIndexSet *)sections collapsed:(BOOL)collapsed animated:(BOOL)animated {
+	if (collapsed) {
+		[self.mutableCollapsedSections addIndexes:sections];
+	} else {
+		[self.mutableCollapsedSections removeIndexes:sections];
+	}
+	
+	if (self.collectionView == nil)
+		return;
+	
+	if ([self updateLayoutForCollapsedSectionsChangedAtIndexes:sections]) {
+		[self.collectionView collectionViewLayout:self didChangeSectionGeometryAnimated:animated];
+	} else {
+		[self invalidateLayout];
+	}
+}
+
+- (BOOL)updateLayoutForCollapsedSectionsChangedAtIndexes:(NSIndexSet *)sections {
+	return NO;
+}
+
+- (NSIndexPath *)indexPathSkippingCollapsedSections:(NSIndexPath *)indexPath forward:(BOOL)forward {
+	JNWCollectionView *collectionView = self.collectionView;
+	while (indexPath != nil && [self isSectionCollapsed:indexPath.jnw_section]) {
+		// Jumping from the edge of the section skips all of its items at once.
+		NSInteger section = indexPath.jnw_section;
+		if (forward) {
+			NSIndexPath *lastIndexPath = [NSIndexPath jnw_indexPathForItem:[collectionView numberOfItemsInSection:section] - 1 inSection:section];
+			indexPath = [collectionView indexPathForNextSelectableItemAfterIndexPath:lastIndexPath];
+		} else {
+			NSIndexPath *firstIndexPath = [NSIndexPath jnw_indexPathForItem:0 inSection:section];
+			indexPath = [collectionView indexPathForNextSelectableItemBeforeIndexPath:firstIndexPath];
+		}
+		
+		// Empty sections can't be skipped this way, so stop rather than loop.
+		if (indexPath.jnw_section == section)
+			return nil;
+	}
+	return indexPath;
+}
+
 #pragma mark Drag and Drop
 
 - (JNWCollectionViewDropIndexPath *)dropIndexPathAtPoint:(NSPoint)point {
@@ -102,6 +243,10 @@
     return nil;
 }
 
+- (void)prepareDropMarker {
+    // For subclasses
+}
+
 - (BOOL)scrollIfNecessaryForDragAtPoint:(CGPoint)point {
     if (self.shouldAutoScroll && self.collectionView) {
         CGRect bounds = self.collectionView.contentView.bounds;
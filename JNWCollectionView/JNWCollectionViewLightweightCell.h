@@ -0,0 +1,40 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewCell.h"
+
+/// A cell that draws its background and selection highlight with plain layers inside
+/// its own layer, instead of using a dedicated background view.
+///
+/// No content view is created automatically. `contentView` returns nil until one is
+/// set, so simple cells can add their sublayers or subviews directly to the cell. This
+/// keeps the number of views and layers per cell to a minimum, which is useful for grids
+/// that display thousands of small items at once.
+@interface JNWCollectionViewLightweightCell : JNWCollectionViewCell
+
+/// The color drawn over the background while the cell is selected.
+///
+/// Defaults to nil, which means selection is not highlighted.
+@property (nonatomic, strong) NSColor *selectionColor;
+
+/// The layer that contains the background image and color. Subclasses can add their
+/// own sublayers to the cell's layer above this one.
+@property (nonatomic, strong, readonly) CALayer *backgroundLayer;
+
+@end
@@ -0,0 +1,147 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewLightweightCell.h"
+#import "JNWCollectionViewCell+Private.h"
+#import "JNWCollectionViewSnapshotCache.h"
+#import <QuartzCore/QuartzCore.h>
+
+@interface JNWCollectionViewLightweightCell()
+@property (nonatomic, strong, readwrite) CALayer *backgroundLayer;
+@property (nonatomic, strong) CALayer *selectionLayer;
+@end
+
+@implementation JNWCollectionViewLightweightCell {
+	NSColor *_backgroundColor;
+	NSImage *_backgroundImage;
+}
+
++ (BOOL)wantsDefaultViewHierarchy {
+	return NO;
+}
+
+- (instancetype)initWithFrame:(NSRect)frameRect {
+	self = [super initWithFrame:frameRect];
+	if (self == nil) return nil;
+	[self _commonLightweightInit];
+	return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)coder {
+	self = [super initWithCoder:coder];
+	if (self == nil) return nil;
+	[self _commonLightweightInit];
+	return self;
+}
+
+- (void)_commonLightweightInit {
+	// The sublayers never animate on their own. Any crossfades are added explicitly.
+	NSDictionary *actions = @{ @"bounds": [NSNull null], @"position": [NSNull null], @"contents": [NSNull null],
+							   @"backgroundColor": [NSNull null], @"hidden": [NSNull null] };
+	
+	_backgroundLayer = [CALayer layer];
+	_backgroundLayer.actions = actions;
+	_backgroundLayer.frame = self.bounds;
+	_backgroundLayer.autoresizingMask = kCALayerWidthSizable | kCALayerHeightSizable;
+	
+	_selectionLayer = [CALayer layer];
+	_selectionLayer.actions = actions;
+	_selectionLayer.frame = self.bounds;
+	_selectionLayer.autoresizingMask = kCALayerWidthSizable | kCALayerHeightSizable;
+	_selectionLayer.hidden = YES;
+	
+	[self.layer insertSublayer:_backgroundLayer atIndex:0];
+	[self.layer insertSublayer:_selectionLayer above:_backgroundLayer];
+}
+
+- (void)setFrameSize:(NSSize)newSize {
+	[super setFrameSize:newSize];
+	
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	self.backgroundLayer.frame = self.bounds;
+	self.selectionLayer.frame = self.bounds;
+	[CATransaction commit];
+}
+
+- (void)prepareForReuse {
+	[super prepareForReuse];
+	[self.selectionLayer removeAllAnimations];
+}
+
+#pragma mark Background
+
+- (void)setBackgroundColor:(NSColor *)backgroundColor {
+	_backgroundColor = backgroundColor;
+	self.backgroundLayer.backgroundColor = backgroundColor.CGColor;
+}
+
+- (NSColor *)backgroundColor {
+	return _backgroundColor;
+}
+
+- (void)setBackgroundImage:(NSImage *)backgroundImage {
+	_backgroundImage = backgroundImage;
+	self.backgroundLayer.contents = backgroundImage;
+}
+
+- (NSImage *)backgroundImage {
+	return _backgroundImage;
+}
+
+#pragma mark Selection
+
+- (void)setSelectionColor:(NSColor *)selectionColor {
+	_selectionColor = selectionColor;
+	self.selectionLayer.backgroundColor = selectionColor.CGColor;
+	self.selectionLayer.hidden = !(self.selected && selectionColor != nil);
+}
+
+- (void)setSelected:(BOOL)selected {
+	[super setSelected:selected];
+	self.selectionLayer.hidden = !(selected && self.selectionColor != nil);
+}
+
+- (void)setSelected:(BOOL)selected animated:(BOOL)animate {
+	if (animate && self.selected != selected) {
+		CATransition *transition = [CATransition animation];
+		transition.duration = self.crossfadeDuration;
+		[self.selectionLayer addAnimation:transition forKey:@"fade"];
+	}
+	
+	self.selected = selected;
+}
+
+#pragma mark Drag and drop
+
+- (NSImage *)draggingImageRepresentation {
+	// The background sublayers are not captured by -cacheDisplayInRect:toBitmapImageRep:, so the layer tree is rendered instead,
+	// the same way as the snapshots taken for high velocity scrolling.
+	NSSize imgSize = self.bounds.size;
+	CGImageRef cgImage = JNWCollectionViewCreateImageOfLayer(self.layer, imgSize, self.window.backingScaleFactor ?: 1);
+	if (cgImage == NULL)
+		return nil;
+	
+	NSImage *image = [[NSImage alloc] initWithCGImage:cgImage size:imgSize];
+	CGImageRelease(cgImage);
+	
+	return image;
+}
+
+@end
@@ -34,6 +34,14 @@ extern NSString * const JNWCollectionViewListLayoutFooterKind;
 /// Instead, `rowHeight` should be set manually for performance improvements.
 - (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForRowAtIndexPath:(NSIndexPath *)indexPath;
 
+/// Asks the delegate whether all rows in the section share the same height, for sections
+/// of a list that otherwise uses -collectionView:heightForRowAtIndexPath:.
+///
+/// Return the height of every row in the section, or 0 if the rows have variable heights.
+/// Rows in a section with a uniform height are positioned arithmetically, so the layout
+/// doesn't ask for or store the height of each row, no matter how many rows there are.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView uniformRowHeightInSection:(NSInteger)section;
+
 /// Asks the delegate for the height of the header or footer in the specified section.
 ///
 /// The default height for both the header and footer is 0.
@@ -42,6 +50,17 @@ extern NSString * const JNWCollectionViewListLayoutFooterKind;
 
 @end
 
+/// A list delegate that conforms to this protocol declares that its implementation of
+/// -collectionView:heightForRowAtIndexPath: is thread-safe.
+///
+/// The list layout then requests row heights concurrently from several background threads
+/// while preparing, which speeds up the preparation of long lists with variable row heights
+/// on machines with multiple cores. The method must not access any views, including the
+/// collection view, other than passing it along. The other delegate methods are still only
+/// called on the main thread.
+@protocol JNWCollectionViewListLayoutConcurrentDelegate <JNWCollectionViewListLayoutDelegate>
+@end
+
 /// A layout subclass that displays items in a vertical list with rows of
 /// items, similar to a table view.
 @interface JNWCollectionViewListLayout : JNWCollectionViewLayout
@@ -56,6 +75,9 @@ extern NSString * const JNWCollectionViewListLayoutFooterKind;
 ///
 /// However, if the delegate method -collectionView:heightForRowAtIndexPath: is
 /// implemented, it will take precedence over any value set here.
+///
+/// When the row height comes from this property, the layout uses constant memory and time
+/// per section regardless of the number of rows.
 @property (nonatomic, assign) CGFloat rowHeight;
 
 /// The spacing between any adjacent cells.
@@ -69,4 +91,38 @@ extern NSString * const JNWCollectionViewListLayoutFooterKind;
 /// Defaults to NO.
 @property (nonatomic, assign) BOOL stickyHeaders;
 
+/// Writes the geometry from the most recent layout pass to a file, so that it can be loaded
+/// with -loadGeometryFromURL:dataVersion:error: on a later launch instead of asking the delegate
+/// for the height of every row.
+///
+/// The data version is an arbitrary value chosen by the caller which should change whenever
+/// the data displayed in the collection view changes.
+- (BOOL)writeGeometryToURL:(NSURL *)URL dataVersion:(uint64_t)dataVersion error:(NSError **)error;
+
+/// Memory maps geometry previously written with -writeGeometryToURL:dataVersion:error:, to be
+/// used by the next layout pass. Fails if the file is invalid, or if it was written with a
+/// different data version, row height, or vertical spacing.
+///
+/// The geometry is only used if the width of the collection view and the number of rows in
+/// each section still match when the layout is next prepared. It is used for that single pass;
+/// any later invalidation or reload computes the geometry from the delegate again.
+- (BOOL)loadGeometryFromURL:(NSURL *)URL dataVersion:(uint64_t)dataVersion error:(NSError **)error;
+
+/// List layouts with the same identifier share the geometry they prepare, so that several collection
+/// views showing the same data, such as the panes of a split view, only ask the delegate for the row
+/// heights once, and keep a single copy of them between them.
+///
+/// The geometry is shared between layouts with the same data version, row height and vertical spacing,
+/// whose collection views have the same width and the same number of rows in each section. Collapsed
+/// sections are not shared, and can differ between the layouts. The delegate of each layout must return
+/// the same heights for the same data version.
+///
+/// Defaults to nil, which doesn't share the geometry.
+@property (nonatomic, copy) NSString *sharedGeometryIdentifier;
+
+/// The version of the data that the shared geometry is calculated for, which should change whenever the
+/// data displayed in the collection views or the heights returned by the delegate change. It has the same
+/// meaning as the data version of geometry files.
+@property (nonatomic, assign) uint64_t sharedGeometryDataVersion;
+
 @end
@@ -18,6 +18,9 @@
  */
 
 #import "JNWCollectionViewListLayout.h"
+#import "JNWCollectionViewLayout+Private.h"
+#import "JNWCollectionViewListLayoutGeometry.h"
+#import "JNWCollectionViewSectionOffsets.h"
 
 typedef struct {
 	CGFloat height;
@@ -33,40 +36,81 @@ NSString * const JNWCollectionViewListLayoutHeaderKind = @"JNWCollectionViewList
 NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewListLayoutFooter";
 
 @interface JNWCollectionViewListLayoutSection : NSObject
-- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows;
-@property (nonatomic, assign) CGRect frame;
+- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows fixedRowHeight:(CGFloat)fixedRowHeight;
+- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows rowInfo:(JNWCollectionViewListLayoutRowInfo *)rowInfo owner:(id)owner;
 @property (nonatomic, assign) NSInteger index;
-@property (nonatomic, assign) CGFloat offset;
-@property (nonatomic, assign) CGFloat height;
+@property (nonatomic, unsafe_unretained) JNWCollectionViewSectionOffsets *sectionOffsets;
+@property (nonatomic, assign, readonly) CGFloat offset; // looked up in the section offsets
+@property (nonatomic, assign) CGFloat height; // the expanded height
+@property (nonatomic, assign) BOOL collapsed;
 @property (nonatomic, assign) CGFloat headerHeight;
 @property (nonatomic, assign) CGFloat footerHeight;
 @property (nonatomic, assign) NSInteger numberOfRows;
-@property (nonatomic, assign) JNWCollectionViewListLayoutRowInfo *rowInfo;
+@property (nonatomic, assign) CGFloat fixedRowHeight; // 0 if the rows have variable heights
+@property (nonatomic, assign) JNWCollectionViewListLayoutRowInfo *rowInfo; // NULL if the rows have a fixed height
+@property (nonatomic, strong, readonly) id rowInfoOwner; // set if the row info is borrowed, and keeps it alive
+@property (nonatomic, assign, readonly) CGFloat visibleHeight;
 @end
 
 @implementation JNWCollectionViewListLayoutSection
 
-- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows {
+- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows fixedRowHeight:(CGFloat)fixedRowHeight {
 	self = [super init];
 	if (self == nil) return nil;
 	_numberOfRows = numberOfRows;
-	self.rowInfo = calloc(numberOfRows, sizeof(JNWCollectionViewListLayoutRowInfo));
+	_fixedRowHeight = fixedRowHeight;
+	
+	// Rows with a fixed height are positioned arithmetically, so nothing needs to be stored per row.
+	if (fixedRowHeight <= 0) {
+		self.rowInfo = calloc(numberOfRows, sizeof(JNWCollectionViewListLayoutRowInfo));
+	}
+	return self;
+}
+
+- (instancetype)initWithNumberOfRows:(NSInteger)numberOfRows rowInfo:(JNWCollectionViewListLayoutRowInfo *)rowInfo owner:(id)owner {
+	self = [super init];
+	if (self == nil) return nil;
+	_numberOfRows = numberOfRows;
+	_rowInfo = rowInfo;
+	_rowInfoOwner = owner;
 	return self;
 }
 
 - (void)dealloc {
-	if (_rowInfo != nil)
+	if (_rowInfo != nil && _rowInfoOwner == nil)
 		free(_rowInfo);
 }
 
+- (CGFloat)offset {
+	return [self.sectionOffsets offsetOfSection:self.index];
+}
+
+- (CGFloat)visibleHeight {
+	// Collapsed sections only show their header.
+	return (self.collapsed ? self.headerHeight : self.height);
+}
+
 @end
 
 @interface JNWCollectionViewListLayout()
 @property (nonatomic, strong) NSMutableArray *sections;
+@property (nonatomic, strong) JNWCollectionViewSectionOffsets *sectionOffsets;
 @property (nonatomic, assign) CGRect lastInvalidatedBounds;
 @property (nonatomic, strong) JNWCollectionViewLayoutAttributes *markerAttributes;
+@property (nonatomic, strong) JNWCollectionViewListLayoutGeometry *cachedGeometry;
+@property (nonatomic, strong) JNWCollectionViewListLayoutGeometry *sharedGeometry; // keeps the geometry in use alive
 @end
 
+// The geometry prepared by layouts with a shared geometry identifier, for as long as any layout uses it.
+static NSMapTable *JNWListLayoutSharedGeometries(void) {
+	static NSMapTable *sharedGeometries = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedGeometries = [NSMapTable strongToWeakObjectsMapTable];
+	});
+	return sharedGeometries;
+}
+
 @implementation JNWCollectionViewListLayout
 
 - (instancetype)init {
@@ -94,87 +138,337 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
 - (void)prepareLayout {
 	[self.sections removeAllObjects];
 	
+	// Cached geometry is only used for a single preparation, so that any later reload or
+	// invalidation picks up changes from the delegate again.
+	JNWCollectionViewListLayoutGeometry *cachedGeometry = self.cachedGeometry;
+	self.cachedGeometry = nil;
+	if (cachedGeometry != nil && [self prepareSectionsWithGeometry:cachedGeometry]) {
+		[self prepareDropMarker];
+		return;
+	}
+	
+	// Another layout may already have prepared the same geometry.
+	NSString *sharedGeometryKey = [self sharedGeometryKey];
+	self.sharedGeometry = nil;
+	if (sharedGeometryKey != nil) {
+		JNWCollectionViewListLayoutGeometry *sharedGeometry = [JNWListLayoutSharedGeometries() objectForKey:sharedGeometryKey];
+		if (sharedGeometry != nil && [self prepareSectionsWithGeometry:sharedGeometry]) {
+			self.sharedGeometry = sharedGeometry;
+			[self prepareDropMarker];
+			return;
+		}
+		[self.sections removeAllObjects];
+	}
+	
 	if (self.delegate != nil && ![self.delegate conformsToProtocol:@protocol(JNWCollectionViewListLayoutDelegate)]) {
 		NSLog(@"*** list delegate does not conform to JNWCollectionViewListLayoutDelegate!");
 	}
 	
 	BOOL delegateHeightForRow = [self.delegate respondsToSelector:@selector(collectionView:heightForRowAtIndexPath:)];
+	BOOL delegateUniformRowHeight = [self.delegate respondsToSelector:@selector(collectionView:uniformRowHeightInSection:)];
 	BOOL delegateHeightForHeader = [self.delegate respondsToSelector:@selector(collectionView:heightForHeaderInSection:)];
 	BOOL delegateHeightForFooter = [self.delegate respondsToSelector:@selector(collectionView:heightForFooterInSection:)];
 	JNWCollectionView *collectionView = self.collectionView;
 	
 	NSUInteger numberOfSections = [self.collectionView numberOfSections];
-	CGFloat totalHeight = 0;
 	CGFloat verticalSpacing = self.verticalSpacing;
 	
+	// The number of rows whose heights have to be requested from the delegate, in each section.
+	NSMutableData *variableRowsData = [NSMutableData dataWithLength:numberOfSections * sizeof(NSInteger)];
+	NSInteger *variableRows = variableRowsData.mutableBytes;
+	
 	for (NSUInteger section = 0; section < numberOfSections; section++) {
 		NSInteger numberOfRows = [collectionView numberOfItemsInSection:section];
 		NSInteger headerHeight = delegateHeightForHeader ? [self.delegate collectionView:collectionView heightForHeaderInSection:section] : 0;
 		NSInteger footerHeight = delegateHeightForFooter ? [self.delegate collectionView:collectionView heightForFooterInSection:section] : 0;
 		
-		JNWCollectionViewListLayoutSection *sectionInfo = [[JNWCollectionViewListLayoutSection alloc] initWithNumberOfRows:numberOfRows];
-		sectionInfo.offset = totalHeight;
-		sectionInfo.height = 0;
+		CGFloat fixedRowHeight = self.rowHeight;
+		if (delegateHeightForRow) {
+			fixedRowHeight = delegateUniformRowHeight ? [self.delegate collectionView:collectionView uniformRowHeightInSection:section] : 0;
+		}
+		
+		JNWCollectionViewListLayoutSection *sectionInfo = [[JNWCollectionViewListLayoutSection alloc] initWithNumberOfRows:numberOfRows fixedRowHeight:MAX(fixedRowHeight, 0)];
 		sectionInfo.headerHeight = headerHeight;
 		sectionInfo.footerHeight = footerHeight;
 		sectionInfo.index = section;
+		[self.sections addObject:sectionInfo];
 		
-		sectionInfo.height += headerHeight; // the footer height is added after cells have determined their offsets
-		
-		for (NSInteger row = 0; row < numberOfRows; row++) {
-			CGFloat rowHeight = self.rowHeight;
+		variableRows[section] = (sectionInfo.fixedRowHeight > 0 ? 0 : numberOfRows);
+	}
+	
+	// Only the section offsets depend on earlier sections, so the row heights and the row offsets
+	// within each section can be calculated in parallel if the delegate allows it.
+	BOOL concurrently = [self.delegate conformsToProtocol:@protocol(JNWCollectionViewListLayoutConcurrentDelegate)];
+	NSArray *sections = [self.sections copy];
+	id<JNWCollectionViewListLayoutDelegate> delegate = self.delegate;
+	CGFloat defaultRowHeight = self.rowHeight;
+	
+	JNWCollectionViewLayoutEnumerateItemRanges(variableRows, numberOfSections, concurrently, ^(NSInteger section, NSRange rows) {
+		JNWCollectionViewListLayoutRowInfo *rowInfo = [sections[section] rowInfo];
+		for (NSUInteger row = rows.location; row < NSMaxRange(rows); row++) {
 			NSIndexPath *indexPath = [NSIndexPath jnw_indexPathForItem:row inSection:section];
-			if (delegateHeightForRow)
-				rowHeight = [self.delegate collectionView:collectionView heightForRowAtIndexPath:indexPath];
-			
-			sectionInfo.rowInfo[row].height = rowHeight;
-			sectionInfo.rowInfo[row].yOffset = sectionInfo.height;
-			sectionInfo.height += rowHeight;
-			sectionInfo.height += verticalSpacing;
+			rowInfo[row].height = (delegateHeightForRow ? [delegate collectionView:collectionView heightForRowAtIndexPath:indexPath] : defaultRowHeight);
 		}
+	});
+	
+	void (^layoutRowsInSection)(size_t) = ^(size_t section) {
+		JNWCollectionViewListLayoutSection *sectionInfo = sections[section];
+		CGFloat height = sectionInfo.headerHeight; // the footer height is added after cells have determined their offsets
 		
-		sectionInfo.height -= verticalSpacing; // We don't want spacing after the last cell.
+		if (sectionInfo.fixedRowHeight > 0) {
+			height += sectionInfo.numberOfRows * (sectionInfo.fixedRowHeight + verticalSpacing);
+		} else {
+			JNWCollectionViewListLayoutRowInfo *rowInfo = sectionInfo.rowInfo;
+			for (NSInteger row = 0; row < sectionInfo.numberOfRows; row++) {
+				rowInfo[row].yOffset = height;
+				height += rowInfo[row].height;
+				height += verticalSpacing;
+			}
+		}
 		
-		sectionInfo.height += footerHeight;
-		sectionInfo.frame = CGRectMake(0, sectionInfo.offset, collectionView.visibleSize.width, sectionInfo.height);
+		height -= verticalSpacing; // We don't want spacing after the last cell.
 		
-		totalHeight += sectionInfo.height;
-		[self.sections addObject:sectionInfo];
+		sectionInfo.height = height + sectionInfo.footerHeight;
+	};
+	
+	if (concurrently) {
+		dispatch_apply(numberOfSections, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), layoutRowsInSection);
+	} else {
+		for (NSUInteger section = 0; section < numberOfSections; section++) {
+			layoutRowsInSection(section);
+		}
 	}
-    
-    if (self.collectionView.dragContext.dropPath) {
-        JNWCollectionViewDropIndexPath *indexPath = self.collectionView.dragContext.dropPath;
-        JNWCollectionViewLayoutAttributes *attributes = [self layoutAttributesForItemAtIndexPath:indexPath];
-        CGRect frame = attributes.frame;
-        if (indexPath.jnw_relation == JNWCollectionViewDropRelationAfter) {
-			frame.origin.y += frame.size.height;
-			NSInteger numberOfRowsForFinalSection = [collectionView numberOfItemsInSection:self.sections.count - 1];
-			// If not dragging to the very last item in the very last section, account for vertical spacing
-			if (indexPath.jnw_section != self.sections.count - 1 || indexPath.jnw_item != numberOfRowsForFinalSection - 1) {
-				frame.origin.y += (self.verticalSpacing / 2);
+	
+	[self prepareSectionOffsets];
+	
+	if (sharedGeometryKey != nil) {
+		[self shareGeometryWithKey:sharedGeometryKey];
+	}
+	
+	[self prepareDropMarker];
+}
+
+/// Stacks the sections on top of each other, taking into account which sections are collapsed.
+- (void)prepareSectionOffsets {
+	NSUInteger numberOfSections = self.sections.count;
+	NSMutableData *heightsData = [NSMutableData dataWithLength:numberOfSections * sizeof(CGFloat)];
+	CGFloat *heights = heightsData.mutableBytes;
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		JNWCollectionViewListLayoutSection *sectionInfo = self.sections[sectionIdx];
+		sectionInfo.collapsed = [self isSectionCollapsed:sectionIdx];
+		heights[sectionIdx] = sectionInfo.visibleHeight;
+	}
+	
+	self.sectionOffsets = [[JNWCollectionViewSectionOffsets alloc] initWithHeights:heights count:numberOfSections];
+	for (JNWCollectionViewListLayoutSection *sectionInfo in self.sections) {
+		sectionInfo.sectionOffsets = self.sectionOffsets;
+	}
+}
+
+- (BOOL)updateLayoutForCollapsedSectionsChangedAtIndexes:(NSIndexSet *)sections {
+	NSUInteger numberOfSections = self.sections.count;
+	
+	// Each section is moved in the offsets individually, unless so many sections change at once
+	// that restacking all of them is cheaper.
+	if (sections.count > numberOfSections / 8) {
+		[self prepareSectionOffsets];
+	} else {
+		[sections enumerateIndexesUsingBlock:^(NSUInteger sectionIdx, BOOL *stop) {
+			if (sectionIdx >= numberOfSections) {
+				*stop = YES;
+				return;
+			}
+			
+			JNWCollectionViewListLayoutSection *sectionInfo = self.sections[sectionIdx];
+			sectionInfo.collapsed = [self isSectionCollapsed:sectionIdx];
+			[self.sectionOffsets setHeight:sectionInfo.visibleHeight ofSection:sectionIdx];
+		}];
+	}
+	
+	[self prepareDropMarker];
+	return YES;
+}
+
+- (BOOL)prepareLayoutForLiveResize {
+	JNWCollectionView *collectionView = self.collectionView;
+	if (self.sections.count != (NSUInteger)[collectionView numberOfSections])
+		return NO;
+	
+	// Row heights are kept from the last preparation, and the sections span the width of the
+	// collection view, so nothing needs to be recalculated.
+	for (JNWCollectionViewListLayoutSection *sectionInfo in self.sections) {
+		if (sectionInfo.numberOfRows != [collectionView numberOfItemsInSection:sectionInfo.index])
+			return NO;
+	}
+	
+	[self prepareDropMarker];
+	return YES;
+}
+
+#pragma mark Geometry Cache
+
+- (BOOL)writeGeometryToURL:(NSURL *)URL dataVersion:(uint64_t)dataVersion error:(NSError **)error {
+	NSData *data = [self geometryDataWithDataVersion:dataVersion];
+	return [data writeToURL:URL options:NSDataWritingAtomic error:error];
+}
+
+- (NSData *)geometryDataWithDataVersion:(uint64_t)dataVersion {
+	NSUInteger numberOfSections = self.sections.count;
+	NSUInteger numberOfRows = 0;
+	for (JNWCollectionViewListLayoutSection *section in self.sections) {
+		if (section.fixedRowHeight <= 0)
+			numberOfRows += section.numberOfRows;
+	}
+	
+	NSMutableData *sectionsData = [NSMutableData dataWithLength:numberOfSections * sizeof(JNWCollectionViewListLayoutGeometrySection)];
+	NSMutableData *rowsData = [NSMutableData dataWithLength:numberOfRows * sizeof(JNWCollectionViewListLayoutGeometryRow)];
+	JNWCollectionViewListLayoutGeometrySection *sections = sectionsData.mutableBytes;
+	JNWCollectionViewListLayoutGeometryRow *rows = rowsData.mutableBytes;
+	
+	NSUInteger rowIdx = 0;
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		JNWCollectionViewListLayoutSection *section = self.sections[sectionIdx];
+		sections[sectionIdx] = (JNWCollectionViewListLayoutGeometrySection){
+			.offset = section.offset,
+			.height = section.height,
+			.headerHeight = section.headerHeight,
+			.footerHeight = section.footerHeight,
+			.fixedRowHeight = section.fixedRowHeight,
+			.numberOfRows = section.numberOfRows,
+			.firstRow = rowIdx
+		};
+		
+		if (section.fixedRowHeight <= 0) {
+			for (NSInteger row = 0; row < section.numberOfRows; row++, rowIdx++) {
+				rows[rowIdx].height = section.rowInfo[row].height;
+				rows[rowIdx].yOffset = section.rowInfo[row].yOffset;
 			}
 		}
-		else {
-			// If not dragging to before the first item, take out vertical spacing
-			if (indexPath.jnw_section != 0 || indexPath.jnw_item != 0)
-				frame.origin.y -= (self.verticalSpacing / 2);
+	}
+	
+	return [JNWCollectionViewListLayoutGeometry dataWithDataVersion:dataVersion
+																	  width:self.collectionView.visibleSize.width
+																  rowHeight:self.rowHeight
+															verticalSpacing:self.verticalSpacing
+																   sections:sections
+														   numberOfSections:numberOfSections
+																	   rows:rows
+															   numberOfRows:numberOfRows];
+}
+
+- (BOOL)loadGeometryFromURL:(NSURL *)URL dataVersion:(uint64_t)dataVersion error:(NSError **)error {
+	JNWCollectionViewListLayoutGeometry *geometry = [[JNWCollectionViewListLayoutGeometry alloc] initWithContentsOfURL:URL error:error];
+	if (geometry == nil)
+		return NO;
+	
+	if (geometry.dataVersion != dataVersion || geometry.rowHeight != self.rowHeight || geometry.verticalSpacing != self.verticalSpacing) {
+		if (error != NULL) {
+			*error = [NSError errorWithDomain:JNWCollectionViewListLayoutGeometryErrorDomain code:JNWCollectionViewListLayoutGeometryErrorMismatch userInfo:@{ NSLocalizedDescriptionKey: @"The geometry file was written for different data or layout parameters." }];
 		}
-		frame.size.height = 2;
-        attributes.frame = frame;
-        self.markerAttributes = attributes;
-    } else {
-        self.markerAttributes = nil;
-    }
+		return NO;
+	}
+	
+	self.cachedGeometry = geometry;
+	return YES;
+}
+
+/// Creates the sections from the cached geometry, provided it still matches the width of the
+/// collection view and the number of rows in each section. Row information is used directly from
+/// the mapped file rather than being copied.
+- (BOOL)prepareSectionsWithGeometry:(JNWCollectionViewListLayoutGeometry *)geometry {
+	JNWCollectionView *collectionView = self.collectionView;
+	CGFloat width = collectionView.visibleSize.width;
+	NSUInteger numberOfSections = [collectionView numberOfSections];
+	
+	if (geometry.width != width || geometry.numberOfSections != numberOfSections)
+		return NO;
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		if (geometry.sections[sectionIdx].numberOfRows != (uint64_t)[collectionView numberOfItemsInSection:sectionIdx])
+			return NO;
+	}
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		JNWCollectionViewListLayoutGeometrySection record = geometry.sections[sectionIdx];
+		JNWCollectionViewListLayoutSection *sectionInfo = nil;
+		
+#if CGFLOAT_IS_DOUBLE
+		if (record.fixedRowHeight <= 0) {
+			// The row records have the same layout as the row info, so they can be borrowed.
+			JNWCollectionViewListLayoutRowInfo *rowInfo = (JNWCollectionViewListLayoutRowInfo *)[geometry rowsInSection:sectionIdx];
+			sectionInfo = [[JNWCollectionViewListLayoutSection alloc] initWithNumberOfRows:(NSInteger)record.numberOfRows rowInfo:rowInfo owner:geometry];
+		}
+#endif
+		if (sectionInfo == nil) {
+			sectionInfo = [[JNWCollectionViewListLayoutSection alloc] initWithNumberOfRows:(NSInteger)record.numberOfRows fixedRowHeight:record.fixedRowHeight];
+			const JNWCollectionViewListLayoutGeometryRow *rows = [geometry rowsInSection:sectionIdx];
+			for (NSInteger row = 0; rows != NULL && row < sectionInfo.numberOfRows; row++) {
+				sectionInfo.rowInfo[row].height = rows[row].height;
+				sectionInfo.rowInfo[row].yOffset = rows[row].yOffset;
+			}
+		}
+		
+		sectionInfo.index = sectionIdx;
+		sectionInfo.height = record.height;
+		sectionInfo.headerHeight = record.headerHeight;
+		sectionInfo.footerHeight = record.footerHeight;
+		[self.sections addObject:sectionInfo];
+	}
+	
+	// The offsets are stacked again rather than read from the file, since the collapsed sections
+	// may have changed since it was written.
+	[self prepareSectionOffsets];
+	return YES;
+}
+
+- (NSString *)sharedGeometryKey {
+	if (self.sharedGeometryIdentifier == nil)
+		return nil;
+	
+	return [NSString stringWithFormat:@"%@|%llu|%g|%g|%g", self.sharedGeometryIdentifier, self.sharedGeometryDataVersion,
+			(double)self.collectionView.visibleSize.width, (double)self.rowHeight, (double)self.verticalSpacing];
 }
 
+/// Publishes the geometry that was just prepared for other layouts with the same key. The sections are
+/// then prepared again from the published geometry, so that the row information is stored only once.
+- (void)shareGeometryWithKey:(NSString *)key {
+	NSData *data = [self geometryDataWithDataVersion:self.sharedGeometryDataVersion];
+	JNWCollectionViewListLayoutGeometry *geometry = [[JNWCollectionViewListLayoutGeometry alloc] initWithData:data error:NULL];
+	if (geometry == nil)
+		return;
+	
+	[JNWListLayoutSharedGeometries() setObject:geometry forKey:key];
+	self.sharedGeometry = geometry;
+	
+#if CGFLOAT_IS_DOUBLE
+	// The row records can only be borrowed when they have the same layout as the row info.
+	NSMutableArray *sections = [self.sections mutableCopy];
+	[self.sections removeAllObjects];
+	if (![self prepareSectionsWithGeometry:geometry]) {
+		self.sections = sections;
+	}
+#endif
+}
+
+#pragma mark Layout Attributes
+
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
 	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
 	attributes.frame = [self rectForItemAtIndex:indexPath.jnw_item section:indexPath.jnw_section];
-	attributes.alpha = 1.f;
+	attributes.alpha = ([self.sections[indexPath.jnw_section] collapsed] ? 0.f : 1.f);
 	return attributes;
 }
 
 - (JNWCollectionViewLayoutAttributes *)layoutAttributesForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = [self rectForSupplementaryItemInSection:sectionIdx kind:kind];
+	attributes.alpha = 1.f;
+	attributes.zIndex = NSIntegerMax;
+	return attributes;
+}
+
+- (CGRect)rectForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
 	JNWCollectionViewListLayoutSection *section = self.sections[sectionIdx];
 	CGFloat width = self.collectionView.visibleSize.width;
 	CGRect frame = CGRectZero;
@@ -185,48 +479,110 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
 		if (self.stickyHeaders) {
 			// Thanks to http://blog.radi.ws/post/32905838158/sticky-headers-for-uicollectionview-using for the inspiration.
 			CGPoint contentOffset = self.collectionView.documentVisibleRect.origin;
-			CGPoint nextHeaderOrigin = CGPointMake(FLT_MAX, FLT_MAX);
+			CGFloat nextHeaderOffset = FLT_MAX;
 			
+			// The next header starts at the top of the next section.
 			if (sectionIdx + 1 < self.sections.count) {
-				JNWCollectionViewLayoutAttributes *nextHeaderAttributes = [self layoutAttributesForSupplementaryItemInSection:sectionIdx + 1 kind:kind];
-				nextHeaderOrigin = nextHeaderAttributes.frame.origin;
+				nextHeaderOffset = [self.sections[sectionIdx + 1] offset];
 			}
 			
-			frame.origin.y = MIN(MAX(contentOffset.y, frame.origin.y), nextHeaderOrigin.y - CGRectGetHeight(frame));
+			frame.origin.y = MIN(MAX(contentOffset.y, frame.origin.y), nextHeaderOffset - CGRectGetHeight(frame));
 		}
 	} else if ([kind isEqualToString:JNWCollectionViewListLayoutFooterKind]) {
-		frame = CGRectMake(0, section.offset + section.height - section.footerHeight, width, section.footerHeight);
+		// The footer of a collapsed section is tucked away underneath its header.
+		CGFloat footerHeight = (section.collapsed ? 0 : section.footerHeight);
+		frame = CGRectMake(0, section.offset + section.visibleHeight - footerHeight, width, footerHeight);
 	}
 	
-	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
-	attributes.frame = frame;
-	attributes.alpha = 1.f;
-	attributes.zIndex = NSIntegerMax;
-	return attributes;
+	return frame;
+}
+
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	NSMutableDictionary *indexesByKind = [NSMutableDictionary dictionary];
+	if (self.sections.count == 0)
+		return indexesByKind;
+	
+	// Supplementary items are always contained in the frame of their section, so only the
+	// sections that intersect the rect need to be checked.
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSString *kind in kinds) {
+		if (![kind isEqualToString:JNWCollectionViewListLayoutHeaderKind] && ![kind isEqualToString:JNWCollectionViewListLayoutFooterKind])
+			continue;
+		
+		NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+		for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+			JNWCollectionViewListLayoutSection *section = self.sections[sectionIdx];
+			if (section.offset >= CGRectGetMaxY(rect))
+				break;
+			if (section.collapsed && [kind isEqualToString:JNWCollectionViewListLayoutFooterKind])
+				continue;
+			
+			if (CGRectIntersectsRect([self rectForSupplementaryItemInSection:sectionIdx kind:kind], rect)) {
+				[indexes addIndex:sectionIdx];
+			}
+		}
+		
+		if (indexes.count > 0) {
+			indexesByKind[kind] = indexes;
+		}
+	}
+	
+	return indexesByKind;
 }
 
 - (BOOL)shouldApplyExistingLayoutAttributesOnLayout {
-	return self.stickyHeaders;
+	return NO;
+}
+
+- (NSArray *)scrollDependentSupplementaryItemKinds {
+	// Only the headers move while scrolling, so there's no need to re-apply the attributes of every visible cell.
+	return (self.stickyHeaders ? @[ JNWCollectionViewListLayoutHeaderKind ] : nil);
 }
 
 - (CGRect)rectForItemAtIndex:(NSInteger)index section:(NSInteger)section {
 	JNWCollectionViewListLayoutSection *sectionInfo = self.sections[section];
-	CGFloat offset = sectionInfo.offset + sectionInfo.rowInfo[index].yOffset;
 	CGFloat width = self.collectionView.visibleSize.width;
-	CGFloat height = sectionInfo.rowInfo[index].height;
-	return CGRectMake(0, offset, width, height);
+	if (sectionInfo.collapsed) {
+		// Rows of a collapsed section are folded up underneath the header.
+		return CGRectMake(0, sectionInfo.offset + sectionInfo.headerHeight, width, 0);
+	}
+	
+	JNWCollectionViewListLayoutRowInfo rowInfo = [self rowInfoForRow:index inSection:sectionInfo];
+	return CGRectMake(0, sectionInfo.offset + rowInfo.yOffset, width, rowInfo.height);
+}
+
+/// Returns the height and the offset relative to the section of the row, calculating them
+/// for sections with a fixed row height.
+- (JNWCollectionViewListLayoutRowInfo)rowInfoForRow:(NSInteger)row inSection:(JNWCollectionViewListLayoutSection *)section {
+	if (section.fixedRowHeight > 0) {
+		CGFloat yOffset = section.headerHeight + row * (section.fixedRowHeight + self.verticalSpacing);
+		return (JNWCollectionViewListLayoutRowInfo){ .height = section.fixedRowHeight, .yOffset = yOffset };
+	}
+	
+	return section.rowInfo[row];
 }
 
 - (CGRect)rectForSectionAtIndex:(NSInteger)index {
 	JNWCollectionViewListLayoutSection *section = self.sections[index];
-	return section.frame;
+	return CGRectMake(0, section.offset, self.collectionView.visibleSize.width, section.visibleHeight);
 }
 
 - (NSArray *)indexPathsForItemsInRect:(CGRect)rect {
 	NSMutableArray *indexPaths = [NSMutableArray array];
 	
-	for (JNWCollectionViewListLayoutSection *section in self.sections) {
-		if (section.numberOfRows > 0 && CGRectIntersectsRect(section.frame, rect)) {
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+		JNWCollectionViewListLayoutSection *section = self.sections[sectionIdx];
+		if (section.offset >= CGRectGetMaxY(rect))
+			break;
+		
+		if (section.numberOfRows > 0 && !section.collapsed && CGRectIntersectsRect([self rectForSectionAtIndex:sectionIdx], rect)) {
 			
 			// Since this is a linear set of data, we run a binary search for optimization
 			// purposes, finding the rects of the upper and lower bound.
@@ -250,6 +606,19 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
 	CGFloat absoluteOffset = (edge == JNWListEdgeTop ? containingRect.origin.y : containingRect.origin.y + containingRect.size.height);
 	CGFloat relativeOffset = absoluteOffset - section.offset;
 	
+	if (section.fixedRowHeight > 0) {
+		NSInteger row = [self rowInSection:section beginningBeforeOffset:absoluteOffset];
+		if (row == NSNotFound)
+			return 0;
+		
+		// Skip the top row if the rect only starts in the spacing below it.
+		JNWCollectionViewListLayoutRowInfo rowInfo = [self rowInfoForRow:row inSection:section];
+		if (edge == JNWListEdgeTop && rowInfo.yOffset + rowInfo.height <= relativeOffset && row < section.numberOfRows - 1)
+			row++;
+		
+		return row;
+	}
+	
 	while (low <= high) {
 		mid = (low + high) / 2;
 		JNWCollectionViewListLayoutRowInfo midInfo = section.rowInfo[mid];
@@ -289,8 +658,10 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
 	
 	if (direction == JNWCollectionViewDirectionUp) {
 		newIndexPath  = [self.collectionView indexPathForNextSelectableItemBeforeIndexPath:currentIndexPath];
+		newIndexPath = [self indexPathSkippingCollapsedSections:newIndexPath forward:NO];
 	} else if (direction == JNWCollectionViewDirectionDown) {
 		newIndexPath = [self.collectionView indexPathForNextSelectableItemAfterIndexPath:currentIndexPath];
+		newIndexPath = [self indexPathSkippingCollapsedSections:newIndexPath forward:YES];
 	}
 	
 	return newIndexPath;
@@ -298,60 +669,67 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
 
 #pragma mark Drag and Drop
 
+- (void)prepareDropMarker {
+	JNWCollectionViewDropIndexPath *indexPath = self.collectionView.dragContext.dropPath;
+	if (indexPath == nil || indexPath.jnw_section >= self.sections.count ||
+		indexPath.jnw_item >= [self.sections[indexPath.jnw_section] numberOfRows] || [self.sections[indexPath.jnw_section] collapsed]) {
+		self.markerAttributes = nil;
+		return;
+	}
+	
+	JNWCollectionViewLayoutAttributes *attributes = [self layoutAttributesForItemAtIndexPath:indexPath];
+	CGRect frame = attributes.frame;
+	if (indexPath.jnw_relation == JNWCollectionViewDropRelationAfter) {
+		frame.origin.y += frame.size.height;
+		JNWCollectionViewListLayoutSection *finalSection = self.sections.lastObject;
+		// If not dragging to the very last item in the very last section, account for vertical spacing
+		if (indexPath.jnw_section != finalSection.index || indexPath.jnw_item != finalSection.numberOfRows - 1) {
+			frame.origin.y += (self.verticalSpacing / 2);
+		}
+	}
+	else {
+		// If not dragging to before the first item, take out vertical spacing
+		if (indexPath.jnw_section != 0 || indexPath.jnw_item != 0)
+			frame.origin.y -= (self.verticalSpacing / 2);
+	}
+	frame.size.height = 2;
+	attributes.frame = frame;
+	self.markerAttributes = attributes;
+}
+
 - (JNWCollectionViewDropIndexPath *)dropIndexPathAtPoint:(NSPoint)point {
     [self scrollIfNecessaryForDragAtPoint:point];
-    /*
-    for (JNWCollectionViewListLayoutSection *section in self.sections) {
-        if (CGRectContainsPoint(section.frame, NSPointToCGPoint(point))) {
-            NSUInteger index = [self rowInSection:section containingPoint:NSPointToCGPoint(point)];
-            if (index == NSNotFound) {
-                return nil;
-            } else {
-                NSIndexPath *testPath = [NSIndexPath jnw_indexPathForItem:index inSection:section.index];
-                if ([self.collectionView.dragContext.dragPaths containsObject:testPath]) {
-                    // Don't drop on a dragged item.
-                    return nil;
-                } else {
-                    
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:index inSection:section.index dropRelation:JNWCollectionViewDropRelationAt];
-                }
-            }
-        }
+    
+    // The section and row are found with binary searches over the cached offsets rather than
+    // by walking the visible cells, so a drag update costs the same regardless of list length.
+    NSInteger sectionIdx = [self sectionIndexAtOffset:point.y];
+    if (sectionIdx == NSNotFound)
+        return nil;
+    
+    JNWCollectionViewListLayoutSection *section = self.sections[sectionIdx];
+    if (section.collapsed)
+        return nil;
+    
+    NSInteger row = [self rowInSection:section beginningBeforeOffset:point.y];
+    if (row == NSNotFound)
+        return nil;
+    
+    JNWCollectionViewListLayoutRowInfo rowInfo = [self rowInfoForRow:row inSection:section];
+    CGFloat relativeOffset = point.y - section.offset;
+    CGFloat rowBottom = rowInfo.yOffset + rowInfo.height;
+    
+    if (relativeOffset <= rowBottom) {
+        JNWCollectionViewDropRelation relation = (relativeOffset <= rowInfo.yOffset + rowInfo.height * 0.5 ? JNWCollectionViewDropRelationAt : JNWCollectionViewDropRelationAfter);
+        return [JNWCollectionViewDropIndexPath indexPathForItem:row inSection:section.index dropRelation:relation];
     }
-     */
     
-    NSArray *visibleCells = [self.collectionView visibleCells];
-    CGFloat halfVerticalSpacing = self.verticalSpacing * 0.5; // calculate this above loop since it is always constant
-    for (JNWCollectionViewCell *cell in visibleCells) {
-        // run a basic check to see if the point is within the actual cell's frame without accounting
-        // for vertical spacing
-        if (CGRectContainsPoint(cell.frame, point)) {
-            NSIndexPath *path = cell.indexPath;
-            if (path) {
-                if (point.y <= cell.frame.origin.y + cell.frame.size.height * 0.5) {
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:path.jnw_item inSection:path.jnw_section dropRelation:JNWCollectionViewDropRelationAt];
-                } else {
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:path.jnw_item inSection:path.jnw_section dropRelation:JNWCollectionViewDropRelationAfter];
-                }
-            }
-        }
-        else {
-            // We may need to account for vertical spacing to know which cell is being dropped on
-            CGRect rectWithSpacing = cell.frame;
-            // see if the drag operation is "between" cells by being "below" the cell
-            rectWithSpacing.size.height += halfVerticalSpacing;
-            if (CGRectContainsPoint(rectWithSpacing, point)) {
-                return [JNWCollectionViewDropIndexPath indexPathForItem:cell.indexPath.jnw_item inSection:cell.indexPath.jnw_section dropRelation:JNWCollectionViewDropRelationAfter];
-            }
-            if (cell.indexPath.jnw_item != 0) {
-                // see if the drag operation is "between" cells by being "above" the cell
-                // (cell 0 can't have an "above" the cell since it is at the top and the verticalSpacing doesn't account for this)
-                rectWithSpacing.origin.y -= halfVerticalSpacing;
-                if (CGRectContainsPoint(rectWithSpacing, point)) {
-                    return [JNWCollectionViewDropIndexPath indexPathForItem:cell.indexPath.jnw_item inSection:cell.indexPath.jnw_section dropRelation:JNWCollectionViewDropRelationAt];
-                }
-            }
-        }
+    // The point is in the spacing below the row. The upper half belongs to this row, and
+    // the lower half belongs to the row underneath it.
+    if (relativeOffset <= rowBottom + self.verticalSpacing * 0.5) {
+        return [JNWCollectionViewDropIndexPath indexPathForItem:row inSection:section.index dropRelation:JNWCollectionViewDropRelationAfter];
+    }
+    if (row + 1 < section.numberOfRows) {
+        return [JNWCollectionViewDropIndexPath indexPathForItem:row + 1 inSection:section.index dropRelation:JNWCollectionViewDropRelationAt];
     }
     
     return nil;
@@ -361,31 +739,42 @@ NSString * const JNWCollectionViewListLayoutFooterKind = @"JNWCollectionViewList
     return self.markerAttributes;
 }
 
-- (NSUInteger)rowInSection:(JNWCollectionViewListLayoutSection *)section containingPoint:(CGPoint)point {
-    NSUInteger numberOfRows = section.numberOfRows;
-    NSUInteger low = 0;
-    NSUInteger high = (numberOfRows > 0) ? numberOfRows - 1 : 0;
-    NSUInteger mid;
-    
-    CGFloat relativeOffset = point.y - section.offset;
-    
-    while (low <= high) {
-        mid = (low + high) / 2;
-        JNWCollectionViewListLayoutRowInfo midInfo = section.rowInfo[mid];
-        
-        if (midInfo.yOffset <= relativeOffset && (midInfo.yOffset + midInfo.height) >= relativeOffset) {
-            return mid;
-        } else if (midInfo.yOffset > relativeOffset && mid > 0) {
-            high = mid - 1;
-        } else if (midInfo.yOffset < relativeOffset && mid < numberOfRows) {
-            low = mid + 1;
-        } else {
-            break;
-        }
-    }
-    
-    return NSNotFound;
+/// Returns the index of the last section starting at or above the offset, or NSNotFound
+/// if the offset is above the first section.
+- (NSInteger)sectionIndexAtOffset:(CGFloat)offset {
+	return [self.sectionOffsets sectionAtOffset:offset];
 }
 
+/// Returns the last row in the section that starts at or above the absolute offset, or
+/// NSNotFound if the offset is above the first row.
+- (NSInteger)rowInSection:(JNWCollectionViewListLayoutSection *)section beginningBeforeOffset:(CGFloat)offset {
+	NSInteger low = 0;
+	NSInteger high = section.numberOfRows - 1;
+	NSInteger result = NSNotFound;
+	
+	CGFloat relativeOffset = offset - section.offset;
+	
+	if (section.fixedRowHeight > 0) {
+		CGFloat rowsOffset = relativeOffset - section.headerHeight;
+		if (rowsOffset < 0 || section.numberOfRows == 0)
+			return NSNotFound;
+		
+		NSInteger row = (NSInteger)floor(rowsOffset / (section.fixedRowHeight + self.verticalSpacing));
+		return MIN(row, section.numberOfRows - 1);
+	}
+	
+	while (low <= high) {
+		NSInteger mid = (low + high) / 2;
+		
+		if (section.rowInfo[mid].yOffset <= relativeOffset) {
+			result = mid;
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	
+	return result;
+}
 
 @end
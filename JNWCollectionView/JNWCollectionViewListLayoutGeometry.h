@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+// This file only depends on Foundation, so that geometry files can be inspected and
+// produced by tools and tests that don't link AppKit.
+
+extern NSString * const JNWCollectionViewListLayoutGeometryErrorDomain;
+
+typedef NS_ENUM(NSInteger, JNWCollectionViewListLayoutGeometryErrorCode) {
+	/// The file is truncated or otherwise not a geometry file.
+	JNWCollectionViewListLayoutGeometryErrorInvalidFile = 1,
+	
+	/// The file was written with an unsupported version of the format.
+	JNWCollectionViewListLayoutGeometryErrorUnsupportedVersion,
+	
+	/// The file is valid, but was written for a different data version or layout parameters.
+	JNWCollectionViewListLayoutGeometryErrorMismatch
+};
+
+/// The version of the file format written by this version of the framework.
+extern const uint32_t JNWCollectionViewListLayoutGeometryFormatVersion;
+
+/// The geometry of a section, as stored in the file. All values are in points, and the
+/// offsets of rows are relative to the top of their section.
+typedef struct {
+	double offset;
+	double height;
+	double headerHeight;
+	double footerHeight;
+	double fixedRowHeight; // 0 if the rows have variable heights
+	uint64_t numberOfRows;
+	uint64_t firstRow; // the index of the first row record, for sections with variable heights
+} JNWCollectionViewListLayoutGeometrySection;
+
+/// The geometry of a single row in a section with variable row heights.
+typedef struct {
+	double height;
+	double yOffset;
+} JNWCollectionViewListLayoutGeometryRow;
+
+/// The prepared geometry of a list layout, in a compact binary format that can be memory
+/// mapped and used directly, without reading or converting the individual rows.
+///
+/// The file consists of a fixed header, followed by an array of section records and an
+/// array of row records for all sections with variable row heights. All values are stored
+/// in little-endian byte order.
+@interface JNWCollectionViewListLayoutGeometry : NSObject
+
+/// Maps the file at the URL into memory and validates its structure.
+///
+/// Returns nil and sets the error if the file cannot be read or is not a valid geometry file.
+- (instancetype)initWithContentsOfURL:(NSURL *)URL error:(NSError **)error;
+
+/// Validates the structure of the data and uses it without copying.
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error;
+
+/// Returns the data of a geometry file containing the sections and rows.
+///
+/// The rows referenced by each section must be stored consecutively, starting at the
+/// section's `firstRow`.
++ (NSData *)dataWithDataVersion:(uint64_t)dataVersion
+						  width:(double)width
+					  rowHeight:(double)rowHeight
+				verticalSpacing:(double)verticalSpacing
+					   sections:(const JNWCollectionViewListLayoutGeometrySection *)sections
+			   numberOfSections:(NSUInteger)numberOfSections
+						   rows:(const JNWCollectionViewListLayoutGeometryRow *)rows
+				   numberOfRows:(NSUInteger)numberOfRows;
+
+/// The underlying data, which may be memory mapped.
+@property (nonatomic, strong, readonly) NSData *data;
+
+/// The version of the content the geometry was calculated for, as provided by the client.
+@property (nonatomic, assign, readonly) uint64_t dataVersion;
+
+/// The layout parameters the geometry was calculated with.
+@property (nonatomic, assign, readonly) double width;
+@property (nonatomic, assign, readonly) double rowHeight;
+@property (nonatomic, assign, readonly) double verticalSpacing;
+
+@property (nonatomic, assign, readonly) NSUInteger numberOfSections;
+
+/// The section records, in order.
+@property (nonatomic, assign, readonly) const JNWCollectionViewListLayoutGeometrySection *sections;
+
+/// Returns the row records of the section, or NULL if the section has a fixed row height.
+- (const JNWCollectionViewListLayoutGeometryRow *)rowsInSection:(NSUInteger)section;
+
+@end
@@ -0,0 +1,149 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewListLayoutGeometry.h"
+
+NSString * const JNWCollectionViewListLayoutGeometryErrorDomain = @"JNWCollectionViewListLayoutGeometryErrorDomain";
+const uint32_t JNWCollectionViewListLayoutGeometryFormatVersion = 1;
+
+static const char JNWCollectionViewListLayoutGeometryMagic[4] = { 'J', 'N', 'W', 'G' };
+
+typedef struct {
+	char magic[4];
+	uint32_t formatVersion;
+	uint64_t dataVersion;
+	double width;
+	double rowHeight;
+	double verticalSpacing;
+	uint64_t numberOfSections;
+	uint64_t numberOfRows;
+} JNWCollectionViewListLayoutGeometryHeader;
+
+// The records are read in place, so their layout must not depend on the compiler.
+_Static_assert(sizeof(JNWCollectionViewListLayoutGeometryHeader) == 56, "Unexpected geometry header size");
+_Static_assert(sizeof(JNWCollectionViewListLayoutGeometrySection) == 56, "Unexpected geometry section size");
+_Static_assert(sizeof(JNWCollectionViewListLayoutGeometryRow) == 16, "Unexpected geometry row size");
+
+static NSError *JNWCollectionViewListLayoutGeometryError(JNWCollectionViewListLayoutGeometryErrorCode code, NSString *description) {
+	return [NSError errorWithDomain:JNWCollectionViewListLayoutGeometryErrorDomain code:code userInfo:@{ NSLocalizedDescriptionKey: description }];
+}
+
+@implementation JNWCollectionViewListLayoutGeometry {
+	const JNWCollectionViewListLayoutGeometryRow *_rows;
+	uint64_t _numberOfRows;
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL *)URL error:(NSError **)error {
+	NSData *data = [NSData dataWithContentsOfURL:URL options:NSDataReadingMappedAlways error:error];
+	if (data == nil)
+		return nil;
+	
+	return [self initWithData:data error:error];
+}
+
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	// The records are stored little-endian and used without conversion.
+	if (NSHostByteOrder() != NS_LittleEndian) {
+		if (error != NULL) *error = JNWCollectionViewListLayoutGeometryError(JNWCollectionViewListLayoutGeometryErrorUnsupportedVersion, @"Geometry files are only supported on little-endian hosts.");
+		return nil;
+	}
+	
+	const JNWCollectionViewListLayoutGeometryHeader *header = data.bytes;
+	if (data.length < sizeof(JNWCollectionViewListLayoutGeometryHeader) || memcmp(header->magic, JNWCollectionViewListLayoutGeometryMagic, sizeof(header->magic)) != 0) {
+		if (error != NULL) *error = JNWCollectionViewListLayoutGeometryError(JNWCollectionViewListLayoutGeometryErrorInvalidFile, @"The data is not a list layout geometry file.");
+		return nil;
+	}
+	
+	if (header->formatVersion != JNWCollectionViewListLayoutGeometryFormatVersion) {
+		if (error != NULL) *error = JNWCollectionViewListLayoutGeometryError(JNWCollectionViewListLayoutGeometryErrorUnsupportedVersion, @"The geometry file was written with an unsupported format version.");
+		return nil;
+	}
+	
+	// The counts are checked against the length before multiplying, so that corrupt counts can't overflow.
+	uint64_t remainingLength = data.length - sizeof(JNWCollectionViewListLayoutGeometryHeader);
+	BOOL validLength = (header->numberOfSections <= remainingLength / sizeof(JNWCollectionViewListLayoutGeometrySection));
+	if (validLength) {
+		remainingLength -= header->numberOfSections * sizeof(JNWCollectionViewListLayoutGeometrySection);
+		validLength = (header->numberOfRows == remainingLength / sizeof(JNWCollectionViewListLayoutGeometryRow) &&
+					   remainingLength % sizeof(JNWCollectionViewListLayoutGeometryRow) == 0);
+	}
+	
+	const JNWCollectionViewListLayoutGeometrySection *sections = (const void *)(header + 1);
+	for (uint64_t section = 0; validLength && section < header->numberOfSections; section++) {
+		if (sections[section].fixedRowHeight <= 0) {
+			validLength = (sections[section].firstRow <= header->numberOfRows && sections[section].numberOfRows <= header->numberOfRows - sections[section].firstRow);
+		}
+	}
+	
+	if (!validLength) {
+		if (error != NULL) *error = JNWCollectionViewListLayoutGeometryError(JNWCollectionViewListLayoutGeometryErrorInvalidFile, @"The geometry file is truncated or corrupt.");
+		return nil;
+	}
+	
+	_data = data;
+	_dataVersion = header->dataVersion;
+	_width = header->width;
+	_rowHeight = header->rowHeight;
+	_verticalSpacing = header->verticalSpacing;
+	_numberOfSections = (NSUInteger)header->numberOfSections;
+	_sections = sections;
+	_rows = (const void *)(sections + header->numberOfSections);
+	_numberOfRows = header->numberOfRows;
+	
+	return self;
+}
+
++ (NSData *)dataWithDataVersion:(uint64_t)dataVersion
+						  width:(double)width
+					  rowHeight:(double)rowHeight
+				verticalSpacing:(double)verticalSpacing
+					   sections:(const JNWCollectionViewListLayoutGeometrySection *)sections
+			   numberOfSections:(NSUInteger)numberOfSections
+						   rows:(const JNWCollectionViewListLayoutGeometryRow *)rows
+				   numberOfRows:(NSUInteger)numberOfRows {
+	JNWCollectionViewListLayoutGeometryHeader header = { .formatVersion = JNWCollectionViewListLayoutGeometryFormatVersion };
+	memcpy(header.magic, JNWCollectionViewListLayoutGeometryMagic, sizeof(header.magic));
+	header.dataVersion = dataVersion;
+	header.width = width;
+	header.rowHeight = rowHeight;
+	header.verticalSpacing = verticalSpacing;
+	header.numberOfSections = numberOfSections;
+	header.numberOfRows = numberOfRows;
+	
+	NSUInteger sectionsLength = numberOfSections * sizeof(JNWCollectionViewListLayoutGeometrySection);
+	NSUInteger rowsLength = numberOfRows * sizeof(JNWCollectionViewListLayoutGeometryRow);
+	NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(header) + sectionsLength + rowsLength];
+	[data appendBytes:&header length:sizeof(header)];
+	[data appendBytes:sections length:sectionsLength];
+	[data appendBytes:rows length:rowsLength];
+	
+	return data;
+}
+
+- (const JNWCollectionViewListLayoutGeometryRow *)rowsInSection:(NSUInteger)section {
+	if (section >= self.numberOfSections || self.sections[section].fixedRowHeight > 0)
+		return NULL;
+	
+	return _rows + self.sections[section].firstRow;
+}
+
+@end
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewListLayout.h"
+
+extern NSString * const JNWCollectionViewMappedRecordErrorDomain;
+
+typedef NS_ENUM(NSInteger, JNWCollectionViewMappedRecordErrorCode) {
+	/// The offset table is empty or its length is not a multiple of 8 bytes.
+	JNWCollectionViewMappedRecordErrorInvalidOffsetTable = 1
+};
+
+/// Returns the cell for a record. The record data references the mapped file directly.
+typedef JNWCollectionViewCell *(^JNWCollectionViewMappedRecordCellProvider)(JNWCollectionView *collectionView, NSIndexPath *indexPath, NSData *record);
+
+/// Returns the row height for a record. This is called concurrently from background threads.
+typedef CGFloat (^JNWCollectionViewMappedRecordHeightProvider)(NSIndexPath *indexPath, const void *bytes, NSUInteger length);
+
+/// A data source and list layout delegate backed by a memory-mapped file of records, for
+/// displaying very large on-disk datasets without loading them into memory first.
+///
+/// Records either all have the same length, or are located through an offset table: a second
+/// file holding one little-endian 64-bit byte offset per record, followed by the end offset of
+/// the last record. Opening either kind of file takes constant time and memory, since nothing is
+/// read until a record is displayed. Offsets are validated as records are accessed, and a record
+/// with offsets outside of the file is returned as empty.
+///
+/// The counts and row heights are read from the mapping, and cells are handed an NSData that
+/// references the record in the mapping without copying it. When used with the list layout and
+/// no height provider, every row uses `rowHeight` and the layout is prepared in constant time.
+@interface JNWCollectionViewMappedRecordDataSource : NSObject <JNWCollectionViewDataSource, JNWCollectionViewListLayoutConcurrentDelegate>
+
+/// Maps a file of records which are all `recordLength` bytes long. Any partial record at the end
+/// of the file is ignored.
+- (instancetype)initWithContentsOfURL:(NSURL *)URL recordLength:(NSUInteger)recordLength error:(NSError **)error;
+
+/// Maps a file of records of varying lengths, along with the offset table locating them.
+- (instancetype)initWithContentsOfURL:(NSURL *)URL offsetTableURL:(NSURL *)offsetTableURL error:(NSError **)error;
+
+/// The mapped records file.
+@property (nonatomic, strong, readonly) NSData *data;
+
+/// The total number of records across all sections.
+@property (nonatomic, assign, readonly) NSUInteger numberOfRecords;
+
+/// The indexes of the records which begin each section. The first section always begins at
+/// record 0, whether or not 0 is included. Indexes beyond the last record are ignored.
+///
+/// Defaults to nil, which displays all records in a single section.
+@property (nonatomic, copy) NSIndexSet *sectionStartIndexes;
+
+/// Called for every cell that is displayed. Required.
+@property (nonatomic, copy) JNWCollectionViewMappedRecordCellProvider cellProvider;
+
+/// Called for the height of every row when preparing a list layout. If this is nil, all rows
+/// have a height of `rowHeight`.
+@property (nonatomic, copy) JNWCollectionViewMappedRecordHeightProvider heightProvider;
+
+/// The height of every row when there is no height provider.
+///
+/// Defaults to 44.
+@property (nonatomic, assign) CGFloat rowHeight;
+
+/// Returns the index of the record at the index path within the whole file.
+- (NSUInteger)recordIndexForIndexPath:(NSIndexPath *)indexPath;
+
+/// Returns a pointer to the record at the index path within the mapping, and its length. The
+/// pointer is valid as long as the data source is.
+- (const void *)bytesForRecordAtIndexPath:(NSIndexPath *)indexPath length:(NSUInteger *)length;
+
+/// Returns the record at the index path. The returned data references the mapping without
+/// copying it, and keeps the mapping alive.
+- (NSData *)recordAtIndexPath:(NSIndexPath *)indexPath;
+
+@end
@@ -0,0 +1,204 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewMappedRecordDataSource.h"
+
+NSString * const JNWCollectionViewMappedRecordErrorDomain = @"JNWCollectionViewMappedRecordErrorDomain";
+
+/// An immutable view of a range of another data object, which it keeps alive.
+@interface JNWCollectionViewMappedRecordSlice : NSData
+- (instancetype)initWithParent:(NSData *)parent bytes:(const void *)bytes length:(NSUInteger)length;
+@end
+
+@implementation JNWCollectionViewMappedRecordSlice {
+	NSData *_parent;
+	const void *_bytes;
+	NSUInteger _length;
+}
+
+- (instancetype)initWithParent:(NSData *)parent bytes:(const void *)bytes length:(NSUInteger)length {
+	self = [super init];
+	if (self == nil) return nil;
+	_parent = parent;
+	_bytes = bytes;
+	_length = length;
+	return self;
+}
+
+- (const void *)bytes {
+	return _bytes;
+}
+
+- (NSUInteger)length {
+	return _length;
+}
+
+@end
+
+@implementation JNWCollectionViewMappedRecordDataSource {
+	NSData *_offsetTable;
+	NSUInteger _recordLength; // 0 if the records are located through the offset table
+	NSUInteger *_sectionStarts; // numberOfSections + 1 entries, the last being numberOfRecords
+	NSUInteger _numberOfSections;
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL *)URL recordLength:(NSUInteger)recordLength error:(NSError **)error {
+	NSParameterAssert(recordLength > 0);
+	
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_data = [NSData dataWithContentsOfURL:URL options:NSDataReadingMappedAlways error:error];
+	if (_data == nil)
+		return nil;
+	
+	_recordLength = recordLength;
+	_numberOfRecords = _data.length / recordLength;
+	[self commonInit];
+	
+	return self;
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL *)URL offsetTableURL:(NSURL *)offsetTableURL error:(NSError **)error {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_data = [NSData dataWithContentsOfURL:URL options:NSDataReadingMappedAlways error:error];
+	_offsetTable = [NSData dataWithContentsOfURL:offsetTableURL options:NSDataReadingMappedAlways error:error];
+	if (_data == nil || _offsetTable == nil)
+		return nil;
+	
+	if (_offsetTable.length < sizeof(uint64_t) || _offsetTable.length % sizeof(uint64_t) != 0) {
+		if (error != NULL) {
+			*error = [NSError errorWithDomain:JNWCollectionViewMappedRecordErrorDomain code:JNWCollectionViewMappedRecordErrorInvalidOffsetTable userInfo:@{ NSLocalizedDescriptionKey: @"The offset table is empty or truncated." }];
+		}
+		return nil;
+	}
+	
+	_numberOfRecords = _offsetTable.length / sizeof(uint64_t) - 1;
+	[self commonInit];
+	
+	return self;
+}
+
+- (void)commonInit {
+	_rowHeight = 44.f;
+	[self updateSectionStarts];
+}
+
+- (void)dealloc {
+	free(_sectionStarts);
+}
+
+#pragma mark Sections
+
+- (void)setSectionStartIndexes:(NSIndexSet *)sectionStartIndexes {
+	_sectionStartIndexes = [sectionStartIndexes copy];
+	[self updateSectionStarts];
+}
+
+- (void)updateSectionStarts {
+	NSIndexSet *indexes = self.sectionStartIndexes;
+	NSUInteger numberOfRecords = self.numberOfRecords;
+	NSUInteger numberOfSections = 1 + [indexes countOfIndexesInRange:NSMakeRange(1, numberOfRecords > 0 ? numberOfRecords - 1 : 0)];
+	
+	NSUInteger *sectionStarts = calloc(numberOfSections + 1, sizeof(NSUInteger));
+	__block NSUInteger section = 1;
+	[indexes enumerateIndexesInRange:NSMakeRange(1, numberOfRecords > 0 ? numberOfRecords - 1 : 0) options:0 usingBlock:^(NSUInteger idx, BOOL *stop) {
+		sectionStarts[section++] = idx;
+	}];
+	sectionStarts[numberOfSections] = numberOfRecords;
+	
+	free(_sectionStarts);
+	_sectionStarts = sectionStarts;
+	_numberOfSections = numberOfSections;
+}
+
+#pragma mark Records
+
+- (NSUInteger)recordIndexForIndexPath:(NSIndexPath *)indexPath {
+	return _sectionStarts[indexPath.jnw_section] + indexPath.jnw_item;
+}
+
+- (const void *)bytesForRecordAtIndexPath:(NSIndexPath *)indexPath length:(NSUInteger *)length {
+	NSUInteger recordIndex = [self recordIndexForIndexPath:indexPath];
+	NSAssert(recordIndex < self.numberOfRecords, @"record index %lu is out of bounds", (unsigned long)recordIndex);
+	
+	const uint8_t *bytes = self.data.bytes;
+	NSUInteger start = 0;
+	NSUInteger end = 0;
+	
+	if (_recordLength > 0) {
+		start = recordIndex * _recordLength;
+		end = start + _recordLength;
+	} else {
+		// Offsets are only checked here, so that opening a file doesn't have to read the whole table.
+		const uint64_t *offsets = _offsetTable.bytes;
+		uint64_t recordStart = NSSwapLittleLongLongToHost(offsets[recordIndex]);
+		uint64_t recordEnd = NSSwapLittleLongLongToHost(offsets[recordIndex + 1]);
+		if (recordStart <= recordEnd && recordEnd <= self.data.length) {
+			start = (NSUInteger)recordStart;
+			end = (NSUInteger)recordEnd;
+		}
+	}
+	
+	if (length != NULL) *length = end - start;
+	return bytes + start;
+}
+
+- (NSData *)recordAtIndexPath:(NSIndexPath *)indexPath {
+	NSUInteger length = 0;
+	const void *bytes = [self bytesForRecordAtIndexPath:indexPath length:&length];
+	return [[JNWCollectionViewMappedRecordSlice alloc] initWithParent:self.data bytes:bytes length:length];
+}
+
+#pragma mark JNWCollectionViewDataSource
+
+- (NSInteger)numberOfSectionsInCollectionView:(JNWCollectionView *)collectionView {
+	return _numberOfSections;
+}
+
+- (NSUInteger)collectionView:(JNWCollectionView *)collectionView numberOfItemsInSection:(NSInteger)section {
+	if (section < 0 || (NSUInteger)section >= _numberOfSections)
+		return 0;
+	return _sectionStarts[section + 1] - _sectionStarts[section];
+}
+
+- (JNWCollectionViewCell *)collectionView:(JNWCollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath {
+	NSAssert(self.cellProvider != nil, @"a cell provider must be set on the mapped record data source");
+	return self.cellProvider(collectionView, indexPath, [self recordAtIndexPath:indexPath]);
+}
+
+#pragma mark JNWCollectionViewListLayoutDelegate
+
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView uniformRowHeightInSection:(NSInteger)section {
+	return (self.heightProvider == nil ? self.rowHeight : 0);
+}
+
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForRowAtIndexPath:(NSIndexPath *)indexPath {
+	JNWCollectionViewMappedRecordHeightProvider heightProvider = self.heightProvider;
+	if (heightProvider == nil)
+		return self.rowHeight;
+	
+	NSUInteger length = 0;
+	const void *bytes = [self bytesForRecordAtIndexPath:indexPath length:&length];
+	return heightProvider(indexPath, bytes, length);
+}
+
+@end
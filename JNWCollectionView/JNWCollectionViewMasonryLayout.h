@@ -0,0 +1,98 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewLayout.h"
+
+@class JNWCollectionViewMasonryLayout;
+
+/// The supplementary view kind identifiers used for the header and the footer.
+extern NSString * const JNWCollectionViewMasonryLayoutHeaderKind;
+extern NSString * const JNWCollectionViewMasonryLayoutFooterKind;
+
+/// The delegate is responsible for returning size information for the masonry layout.
+@protocol JNWCollectionViewMasonryLayoutDelegate <NSObject>
+
+/// Asks the delegate for the height of the item at the specified index path.
+///
+/// All items in a section have the same width, which can be retrieved with
+/// -columnWidthInSection: on the layout.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+@optional
+
+/// Asks the delegate for the number of columns in the specified section.
+///
+/// If this method is not implemented, `numberOfColumns` is used for every section.
+- (NSUInteger)collectionView:(JNWCollectionView *)collectionView layout:(JNWCollectionViewMasonryLayout *)collectionViewLayout numberOfColumnsInSection:(NSInteger)section;
+
+/// Asks the delegate for the height of the header or footer in the specified section.
+///
+/// The default height for both the header and footer is 0.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForHeaderInSection:(NSInteger)index;
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForFooterInSection:(NSInteger)index;
+
+/// Asks the delegate for section insets for a section in the masonry layout.
+///
+/// The default is (0, 0, 0, 0).
+- (NSEdgeInsets)collectionView:(JNWCollectionView *)collectionView layout:(JNWCollectionViewMasonryLayout *)collectionViewLayout insetForSectionAtIndex:(NSInteger)section;
+
+@end
+
+/// A layout subclass that displays items of variable heights in equally wide columns.
+///
+/// Each item is placed in the column that is currently the shortest, so that the columns
+/// grow evenly. Items are indexed by column, so finding the items in a rect only takes
+/// time proportional to the number of items in it.
+@interface JNWCollectionViewMasonryLayout : JNWCollectionViewLayout
+
+/// The delegate for the masonry layout. The delegate should be set before the
+/// collection view is reloaded.
+@property (nonatomic, unsafe_unretained) id<JNWCollectionViewMasonryLayoutDelegate> delegate;
+
+/// The number of columns in every section, unless the delegate specifies otherwise.
+///
+/// Defaults to 2.
+@property (nonatomic, assign) NSUInteger numberOfColumns;
+
+/// The horizontal spacing between adjacent columns.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) CGFloat columnSpacing;
+
+/// The vertical spacing between adjacent items in a column.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) CGFloat verticalSpacing;
+
+/// The width of the items in the specified section, or 0 if the section does not exist.
+///
+/// This is valid from within -collectionView:heightForItemAtIndexPath:.
+- (CGFloat)columnWidthInSection:(NSInteger)section;
+
+/// Invalidates the layout after items were only added to the end of the last section.
+///
+/// The items that were already laid out keep their positions, and only the new items are
+/// measured and placed, which keeps loading more items into an endless feed cheap. If
+/// anything else has changed, such as the number of sections or the width of the collection
+/// view, the whole layout is recalculated as if -invalidateLayout was called.
+///
+/// This should be called instead of reloading the collection view.
+- (void)invalidateLayoutForAppendedItems;
+
+@end
@@ -0,0 +1,441 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewMasonryLayout.h"
+
+typedef struct {
+	CGRect frame; // relative to the top of the section
+	NSInteger column;
+	NSInteger indexInColumn;
+} JNWCollectionViewMasonryLayoutItemInfo;
+
+typedef struct {
+	NSInteger *items; // item indexes, sorted from top to bottom
+	NSInteger count;
+	NSInteger capacity;
+	CGFloat height; // relative to the top of the first item
+} JNWCollectionViewMasonryLayoutColumn;
+
+NSString * const JNWCollectionViewMasonryLayoutHeaderKind = @"JNWCollectionViewMasonryLayoutHeader";
+NSString * const JNWCollectionViewMasonryLayoutFooterKind = @"JNWCollectionViewMasonryLayoutFooter";
+
+@interface JNWCollectionViewMasonryLayoutSection : NSObject
+- (instancetype)initWithNumberOfColumns:(NSInteger)numberOfColumns;
+@property (nonatomic, assign) NSInteger index;
+@property (nonatomic, assign) CGFloat offset;
+@property (nonatomic, assign) CGFloat headerHeight;
+@property (nonatomic, assign) CGFloat footerHeight;
+@property (nonatomic, assign) NSEdgeInsets insets;
+@property (nonatomic, assign) CGFloat columnWidth;
+@property (nonatomic, assign) CGFloat columnSpacing;
+@property (nonatomic, assign) CGFloat verticalSpacing;
+@property (nonatomic, assign, readonly) NSInteger numberOfColumns;
+@property (nonatomic, assign, readonly) NSInteger numberOfItems;
+@property (nonatomic, assign, readonly) JNWCollectionViewMasonryLayoutItemInfo *itemInfo;
+@property (nonatomic, assign, readonly) JNWCollectionViewMasonryLayoutColumn *columns;
+@property (nonatomic, assign, readonly) CGFloat itemsOffset;
+@property (nonatomic, assign, readonly) CGFloat height;
+@end
+
+@implementation JNWCollectionViewMasonryLayoutSection {
+	NSInteger _itemCapacity;
+}
+
+- (instancetype)initWithNumberOfColumns:(NSInteger)numberOfColumns {
+	self = [super init];
+	if (self == nil) return nil;
+	_numberOfColumns = numberOfColumns;
+	_columns = calloc(numberOfColumns, sizeof(JNWCollectionViewMasonryLayoutColumn));
+	return self;
+}
+
+- (void)dealloc {
+	for (NSInteger column = 0; column < _numberOfColumns; column++) {
+		free(_columns[column].items);
+	}
+	free(_columns);
+	free(_itemInfo);
+}
+
+- (CGFloat)itemsOffset {
+	return self.headerHeight + self.insets.top;
+}
+
+- (CGFloat)height {
+	CGFloat itemsHeight = 0;
+	for (NSInteger column = 0; column < _numberOfColumns; column++) {
+		itemsHeight = MAX(itemsHeight, _columns[column].height);
+	}
+	
+	return self.itemsOffset + itemsHeight + self.insets.bottom + self.footerHeight;
+}
+
+- (void)reserveCapacityForNumberOfItems:(NSInteger)numberOfItems {
+	if (numberOfItems <= _itemCapacity)
+		return;
+	
+	_itemCapacity = MAX(numberOfItems, _itemCapacity * 2);
+	_itemInfo = realloc(_itemInfo, _itemCapacity * sizeof(JNWCollectionViewMasonryLayoutItemInfo));
+}
+
+/// Places the next item at the bottom of the shortest column, preferring the leftmost
+/// column if several are equally short.
+- (void)addItemWithHeight:(CGFloat)height {
+	NSInteger shortestColumn = 0;
+	for (NSInteger column = 1; column < _numberOfColumns; column++) {
+		if (_columns[column].height < _columns[shortestColumn].height) {
+			shortestColumn = column;
+		}
+	}
+	
+	JNWCollectionViewMasonryLayoutColumn *column = &_columns[shortestColumn];
+	CGFloat y = column->height + (column->count > 0 ? self.verticalSpacing : 0);
+	CGFloat x = self.insets.left + shortestColumn * (self.columnWidth + self.columnSpacing);
+	
+	[self reserveCapacityForNumberOfItems:_numberOfItems + 1];
+	_itemInfo[_numberOfItems].frame = CGRectMake(x, self.itemsOffset + y, self.columnWidth, height);
+	_itemInfo[_numberOfItems].column = shortestColumn;
+	_itemInfo[_numberOfItems].indexInColumn = column->count;
+	
+	if (column->count == column->capacity) {
+		column->capacity = MAX(16, column->capacity * 2);
+		column->items = realloc(column->items, column->capacity * sizeof(NSInteger));
+	}
+	column->items[column->count] = _numberOfItems;
+	column->count++;
+	column->height = y + height;
+	
+	_numberOfItems++;
+}
+
+/// Returns the first position in the column whose item ends below the offset relative to the
+/// top of the section, or the number of items in the column if there is none.
+- (NSInteger)indexInColumn:(NSInteger)columnIdx endingBelowOffset:(CGFloat)offset {
+	JNWCollectionViewMasonryLayoutColumn column = _columns[columnIdx];
+	NSInteger low = 0;
+	NSInteger high = column.count;
+	
+	// The items in a column don't overlap, so their bottom edges are sorted as well.
+	while (low < high) {
+		NSInteger mid = (low + high) / 2;
+		if (CGRectGetMaxY(_itemInfo[column.items[mid]].frame) > offset) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	
+	return low;
+}
+
+@end
+
+@interface JNWCollectionViewMasonryLayout()
+@property (nonatomic, strong) NSMutableArray *sections;
+@property (nonatomic, assign) CGRect lastInvalidatedBounds;
+@property (nonatomic, assign) CGFloat preparedWidth;
+@property (nonatomic, assign) BOOL onlyItemsAppended;
+@end
+
+@implementation JNWCollectionViewMasonryLayout
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	self.numberOfColumns = 2;
+	return self;
+}
+
+- (NSMutableArray *)sections {
+	if (_sections == nil) {
+		_sections = [NSMutableArray array];
+	}
+	return _sections;
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds {
+	if (newBounds.size.width != self.lastInvalidatedBounds.size.width) {
+		self.lastInvalidatedBounds = newBounds;
+		return YES;
+	}
+	
+	return NO;
+}
+
+- (void)invalidateLayoutForAppendedItems {
+	self.onlyItemsAppended = YES;
+	[self invalidateLayout];
+	self.onlyItemsAppended = NO;
+}
+
+- (void)prepareLayout {
+	if (self.delegate != nil && ![self.delegate conformsToProtocol:@protocol(JNWCollectionViewMasonryLayoutDelegate)]) {
+		NSLog(@"*** masonry delegate does not conform to JNWCollectionViewMasonryLayoutDelegate!");
+	}
+	
+	if (self.onlyItemsAppended && [self canAppendItems]) {
+		JNWCollectionViewMasonryLayoutSection *section = self.sections.lastObject;
+		[self addItemsToSection:section numberOfItems:[self.collectionView numberOfItemsInSection:section.index]];
+		return;
+	}
+	
+	[self.sections removeAllObjects];
+	
+	BOOL delegateNumberOfColumns = [self.delegate respondsToSelector:@selector(collectionView:layout:numberOfColumnsInSection:)];
+	BOOL delegateHeightForHeader = [self.delegate respondsToSelector:@selector(collectionView:heightForHeaderInSection:)];
+	BOOL delegateHeightForFooter = [self.delegate respondsToSelector:@selector(collectionView:heightForFooterInSection:)];
+	BOOL delegateForSectionInsets = [self.delegate respondsToSelector:@selector(collectionView:layout:insetForSectionAtIndex:)];
+	JNWCollectionView *collectionView = self.collectionView;
+	
+	NSUInteger numberOfSections = [collectionView numberOfSections];
+	CGFloat width = collectionView.visibleSize.width;
+	CGFloat totalHeight = 0;
+	
+	for (NSUInteger sectionIdx = 0; sectionIdx < numberOfSections; sectionIdx++) {
+		NSInteger numberOfColumns = delegateNumberOfColumns ? [self.delegate collectionView:collectionView layout:self numberOfColumnsInSection:sectionIdx] : self.numberOfColumns;
+		NSEdgeInsets insets = delegateForSectionInsets ? [self.delegate collectionView:collectionView layout:self insetForSectionAtIndex:sectionIdx] : NSEdgeInsetsMake(0, 0, 0, 0);
+		numberOfColumns = MAX(numberOfColumns, 1);
+		
+		JNWCollectionViewMasonryLayoutSection *section = [[JNWCollectionViewMasonryLayoutSection alloc] initWithNumberOfColumns:numberOfColumns];
+		section.index = sectionIdx;
+		section.offset = totalHeight;
+		section.insets = insets;
+		section.headerHeight = delegateHeightForHeader ? [self.delegate collectionView:collectionView heightForHeaderInSection:sectionIdx] : 0;
+		section.footerHeight = delegateHeightForFooter ? [self.delegate collectionView:collectionView heightForFooterInSection:sectionIdx] : 0;
+		section.columnSpacing = self.columnSpacing;
+		section.verticalSpacing = self.verticalSpacing;
+		
+		CGFloat availableWidth = width - insets.left - insets.right - self.columnSpacing * (numberOfColumns - 1);
+		section.columnWidth = MAX(0, floor(availableWidth / numberOfColumns));
+		
+		// The section needs to be reachable while the delegate is asked for item heights,
+		// so that it can look up the column width.
+		[self.sections addObject:section];
+		[self addItemsToSection:section numberOfItems:[collectionView numberOfItemsInSection:sectionIdx]];
+		
+		totalHeight += section.height;
+	}
+	
+	self.preparedWidth = width;
+}
+
+/// Returns whether the only change since the last preparation is that items were added to
+/// the end of the last section.
+- (BOOL)canAppendItems {
+	JNWCollectionView *collectionView = self.collectionView;
+	if (self.sections.count == 0 || self.sections.count != [collectionView numberOfSections])
+		return NO;
+	if (self.preparedWidth != collectionView.visibleSize.width)
+		return NO;
+	
+	for (JNWCollectionViewMasonryLayoutSection *section in self.sections) {
+		NSInteger numberOfItems = [collectionView numberOfItemsInSection:section.index];
+		if (section == self.sections.lastObject ? numberOfItems < section.numberOfItems : numberOfItems != section.numberOfItems)
+			return NO;
+	}
+	
+	return YES;
+}
+
+- (void)addItemsToSection:(JNWCollectionViewMasonryLayoutSection *)section numberOfItems:(NSInteger)numberOfItems {
+	[section reserveCapacityForNumberOfItems:numberOfItems];
+	
+	for (NSInteger item = section.numberOfItems; item < numberOfItems; item++) {
+		NSIndexPath *indexPath = [NSIndexPath jnw_indexPathForItem:item inSection:section.index];
+		CGFloat height = [self.delegate collectionView:self.collectionView heightForItemAtIndexPath:indexPath];
+		[section addItemWithHeight:MAX(height, 0)];
+	}
+}
+
+- (CGFloat)columnWidthInSection:(NSInteger)section {
+	if (section < 0 || section >= self.sections.count)
+		return 0;
+	
+	return [self.sections[section] columnWidth];
+}
+
+- (JNWCollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = [self rectForItemAtIndexPath:indexPath];
+	attributes.alpha = 1.f;
+	return attributes;
+}
+
+- (CGRect)rectForItemAtIndexPath:(NSIndexPath *)indexPath {
+	JNWCollectionViewMasonryLayoutSection *section = self.sections[indexPath.jnw_section];
+	return CGRectOffset(section.itemInfo[indexPath.jnw_item].frame, 0, section.offset);
+}
+
+- (JNWCollectionViewLayoutAttributes *)layoutAttributesForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = [self rectForSupplementaryItemInSection:sectionIdx kind:kind];
+	attributes.alpha = 1.f;
+	attributes.zIndex = NSIntegerMax;
+	return attributes;
+}
+
+- (CGRect)rectForSupplementaryItemInSection:(NSInteger)sectionIdx kind:(NSString *)kind {
+	JNWCollectionViewMasonryLayoutSection *section = self.sections[sectionIdx];
+	CGFloat width = self.collectionView.visibleSize.width;
+	
+	if ([kind isEqualToString:JNWCollectionViewMasonryLayoutHeaderKind]) {
+		return CGRectMake(0, section.offset, width, section.headerHeight);
+	} else if ([kind isEqualToString:JNWCollectionViewMasonryLayoutFooterKind]) {
+		return CGRectMake(0, section.offset + section.height - section.footerHeight, width, section.footerHeight);
+	}
+	
+	return CGRectZero;
+}
+
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	NSMutableDictionary *indexesByKind = [NSMutableDictionary dictionary];
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSString *kind in kinds) {
+		if (![kind isEqualToString:JNWCollectionViewMasonryLayoutHeaderKind] && ![kind isEqualToString:JNWCollectionViewMasonryLayoutFooterKind])
+			continue;
+		
+		NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+		for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+			JNWCollectionViewMasonryLayoutSection *section = self.sections[sectionIdx];
+			if (section.offset >= CGRectGetMaxY(rect))
+				break;
+			
+			if (CGRectIntersectsRect([self rectForSupplementaryItemInSection:sectionIdx kind:kind], rect)) {
+				[indexes addIndex:sectionIdx];
+			}
+		}
+		
+		if (indexes.count > 0) {
+			indexesByKind[kind] = indexes;
+		}
+	}
+	
+	return indexesByKind;
+}
+
+- (BOOL)shouldApplyExistingLayoutAttributesOnLayout {
+	return NO;
+}
+
+- (CGRect)rectForSectionAtIndex:(NSInteger)index {
+	JNWCollectionViewMasonryLayoutSection *section = self.sections[index];
+	return CGRectMake(0, section.offset, self.collectionView.visibleSize.width, section.height);
+}
+
+- (NSArray *)indexPathsForItemsInRect:(CGRect)rect {
+	NSMutableArray *indexPaths = [NSMutableArray array];
+	NSInteger firstSection = [self sectionIndexAtOffset:CGRectGetMinY(rect)];
+	if (firstSection == NSNotFound)
+		firstSection = 0;
+	
+	for (NSInteger sectionIdx = firstSection; sectionIdx < self.sections.count; sectionIdx++) {
+		JNWCollectionViewMasonryLayoutSection *section = self.sections[sectionIdx];
+		if (section.offset >= CGRectGetMaxY(rect))
+			break;
+		
+		CGRect relativeRect = CGRectOffset(rect, 0, -section.offset);
+		NSMutableIndexSet *items = [NSMutableIndexSet indexSet];
+		
+		// Each column is searched for its first item in the rect, and then walked until
+		// the items are below the rect.
+		for (NSInteger columnIdx = 0; columnIdx < section.numberOfColumns; columnIdx++) {
+			JNWCollectionViewMasonryLayoutColumn column = section.columns[columnIdx];
+			CGFloat columnX = section.insets.left + columnIdx * (section.columnWidth + section.columnSpacing);
+			if (columnX >= CGRectGetMaxX(relativeRect) || columnX + section.columnWidth <= CGRectGetMinX(relativeRect))
+				continue;
+			
+			NSInteger position = [section indexInColumn:columnIdx endingBelowOffset:CGRectGetMinY(relativeRect)];
+			for (; position < column.count; position++) {
+				NSInteger item = column.items[position];
+				if (CGRectGetMinY(section.itemInfo[item].frame) >= CGRectGetMaxY(relativeRect))
+					break;
+				
+				[items addIndex:item];
+			}
+		}
+		
+		[items enumerateIndexesUsingBlock:^(NSUInteger item, BOOL *stop) {
+			[indexPaths addObject:[NSIndexPath jnw_indexPathForItem:item inSection:sectionIdx]];
+		}];
+	}
+	
+	return indexPaths;
+}
+
+- (NSIndexPath *)indexPathForNextItemInDirection:(JNWCollectionViewDirection)direction currentIndexPath:(NSIndexPath *)currentIndexPath {
+	if (currentIndexPath == nil || currentIndexPath.jnw_section >= self.sections.count)
+		return currentIndexPath;
+	
+	JNWCollectionViewMasonryLayoutSection *section = self.sections[currentIndexPath.jnw_section];
+	if (currentIndexPath.jnw_item >= section.numberOfItems)
+		return currentIndexPath;
+	
+	JNWCollectionViewMasonryLayoutItemInfo itemInfo = section.itemInfo[currentIndexPath.jnw_item];
+	JNWCollectionViewMasonryLayoutColumn column = section.columns[itemInfo.column];
+	
+	if (direction == JNWCollectionViewDirectionUp) {
+		if (itemInfo.indexInColumn > 0)
+			return [NSIndexPath jnw_indexPathForItem:column.items[itemInfo.indexInColumn - 1] inSection:section.index];
+		return [self.collectionView indexPathForNextSelectableItemBeforeIndexPath:currentIndexPath];
+	} else if (direction == JNWCollectionViewDirectionDown) {
+		if (itemInfo.indexInColumn + 1 < column.count)
+			return [NSIndexPath jnw_indexPathForItem:column.items[itemInfo.indexInColumn + 1] inSection:section.index];
+		return [self.collectionView indexPathForNextSelectableItemAfterIndexPath:currentIndexPath];
+	}
+	
+	// Moving sideways picks the item in the adjacent column closest to the vertical center of the current item.
+	NSInteger adjacentColumnIdx = itemInfo.column + (direction == JNWCollectionViewDirectionLeft ? -1 : 1);
+	if (adjacentColumnIdx < 0 || adjacentColumnIdx >= section.numberOfColumns)
+		return currentIndexPath;
+	
+	JNWCollectionViewMasonryLayoutColumn adjacentColumn = section.columns[adjacentColumnIdx];
+	if (adjacentColumn.count == 0)
+		return currentIndexPath;
+	
+	NSInteger position = [section indexInColumn:adjacentColumnIdx endingBelowOffset:CGRectGetMidY(itemInfo.frame)];
+	position = MIN(position, adjacentColumn.count - 1);
+	return [NSIndexPath jnw_indexPathForItem:adjacentColumn.items[position] inSection:section.index];
+}
+
+/// Returns the index of the last section starting at or above the offset, or NSNotFound
+/// if the offset is above the first section.
+- (NSInteger)sectionIndexAtOffset:(CGFloat)offset {
+	NSInteger low = 0;
+	NSInteger high = self.sections.count - 1;
+	NSInteger result = NSNotFound;
+	
+	while (low <= high) {
+		NSInteger mid = (low + high) / 2;
+		JNWCollectionViewMasonryLayoutSection *section = self.sections[mid];
+		
+		if (section.offset <= offset) {
+			result = mid;
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	
+	return result;
+}
+
+@end
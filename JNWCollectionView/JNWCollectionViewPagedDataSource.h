@@ -0,0 +1,103 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewFramework.h"
+
+/// A backend which loads the objects shown by a paged data source.
+///
+/// Pages are requested around the items being displayed, so a backend using keyset pagination
+/// can map a range onto a key by remembering the last key of the pages it has already returned.
+@protocol JNWCollectionViewPagedBackend <NSObject>
+
+/// Loads the objects in the range, and calls the completion handler with them on any thread.
+///
+/// Fewer objects than requested should only be returned at the end of the data, which tells the
+/// data source the exact number of objects. Pass nil and an error if the page couldn't be loaded;
+/// it is requested again after a delay which doubles with every failure, from one second up to a
+/// minute, as long as it's still around the items being displayed.
+- (void)fetchObjectsInRange:(NSRange)range completionHandler:(void (^)(NSArray *objects, NSError *error))completionHandler;
+
+@optional
+
+/// An estimate of the total number of objects, used until the end of the data has been loaded.
+/// If this is not implemented, the count starts at one page and grows as pages are loaded.
+- (NSUInteger)estimatedNumberOfObjects;
+
+@end
+
+/// Returns the cell for an item. The object is nil while the page containing it is being loaded,
+/// in which case a placeholder cell should be returned.
+typedef JNWCollectionViewCell *(^JNWCollectionViewPagedCellProvider)(JNWCollectionView *collectionView, NSIndexPath *indexPath, id object);
+
+/// A data source for a single section of items which are loaded in pages, for datasets that are
+/// too large or too slow to load up front.
+///
+/// When a cell is requested, the page containing it and `numberOfLookaheadPages` pages on either
+/// side are fetched asynchronously from the backend, and a placeholder is shown until the page
+/// arrives. Only the visible cells in a page are reloaded when it arrives. Pages furthest from the
+/// most recently displayed item are evicted once more than `maximumNumberOfLoadedPages` are loaded.
+///
+/// The number of items is an estimate until the backend returns a partial page. If it changes,
+/// items are inserted or deleted at the end of the collection view, or it is reloaded if the
+/// change exceeds `maximumNumberOfBatchUpdates`.
+///
+/// All methods must be called from the main thread.
+@interface JNWCollectionViewPagedDataSource : NSObject <JNWCollectionViewDataSource>
+
+- (instancetype)initWithBackend:(id<JNWCollectionViewPagedBackend>)backend pageSize:(NSUInteger)pageSize;
+
+@property (nonatomic, strong, readonly) id<JNWCollectionViewPagedBackend> backend;
+@property (nonatomic, assign, readonly) NSUInteger pageSize;
+
+/// The collection view which is updated as pages arrive. This must be set, and the data source
+/// should also be set as its data source.
+@property (nonatomic, unsafe_unretained) JNWCollectionView *collectionView;
+
+/// Called for every cell that is displayed. Required.
+@property (nonatomic, copy) JNWCollectionViewPagedCellProvider cellProvider;
+
+/// The number of pages loaded ahead of and behind the page being displayed.
+///
+/// Defaults to 1.
+@property (nonatomic, assign) NSUInteger numberOfLookaheadPages;
+
+/// The number of pages kept in memory before the pages furthest from the viewport are evicted.
+///
+/// Defaults to 16.
+@property (nonatomic, assign) NSUInteger maximumNumberOfLoadedPages;
+
+/// The largest change in the number of items that is applied as a batch update inserting or deleting
+/// items at the end. Larger changes, such as an estimate settling on a much smaller exact number,
+/// reload the collection view instead.
+///
+/// Defaults to the page size, so that the list growing by a page at a time is never reloaded.
+@property (nonatomic, assign) NSUInteger maximumNumberOfBatchUpdates;
+
+/// The current number of items, which is an estimate unless `hasExactNumberOfItems` is YES.
+@property (nonatomic, assign, readonly) NSUInteger numberOfItems;
+@property (nonatomic, assign, readonly) BOOL hasExactNumberOfItems;
+
+/// Returns the object at the index, or nil if its page is not loaded.
+- (id)objectAtIndex:(NSUInteger)index;
+
+/// Discards all loaded pages and the number of items, and reloads the collection view.
+/// Responses to requests made before this are ignored.
+- (void)reloadAllPages;
+
+@end
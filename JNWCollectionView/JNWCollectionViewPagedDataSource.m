@@ -0,0 +1,263 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewPagedDataSource.h"
+#import <QuartzCore/QuartzCore.h>
+
+// A page that failed to load is retried after this delay, doubled for every further failure up to the maximum.
+static const NSTimeInterval JNWCollectionViewPagedDataSourceInitialRetryDelay = 1.0;
+static const NSTimeInterval JNWCollectionViewPagedDataSourceMaximumRetryDelay = 60.0;
+
+@interface JNWCollectionViewPagedDataSource()
+@property (nonatomic, strong) NSMutableDictionary *pages; // page index -> array of objects
+@property (nonatomic, strong) NSMutableIndexSet *pendingPages;
+@property (nonatomic, strong) NSMutableDictionary *failedPages; // page index -> number of consecutive failures
+@property (nonatomic, strong) NSMutableDictionary *pageRetryTimes; // page index -> time before which the page isn't requested again
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, assign) NSUInteger lastDisplayedPage;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfItems;
+@property (nonatomic, assign, readwrite) BOOL hasExactNumberOfItems;
+@property (nonatomic, assign) NSUInteger numberOfDisplayedItems; // the number of items the collection view knows about
+@property (nonatomic, assign) BOOL performingBatchUpdates;
+@end
+
+@implementation JNWCollectionViewPagedDataSource
+
+- (instancetype)initWithBackend:(id<JNWCollectionViewPagedBackend>)backend pageSize:(NSUInteger)pageSize {
+	NSParameterAssert(backend);
+	NSParameterAssert(pageSize > 0);
+	
+	self = [super init];
+	if (self == nil) return nil;
+	_backend = backend;
+	_pageSize = pageSize;
+	_pages = [NSMutableDictionary dictionary];
+	_pendingPages = [NSMutableIndexSet indexSet];
+	_failedPages = [NSMutableDictionary dictionary];
+	_pageRetryTimes = [NSMutableDictionary dictionary];
+	_numberOfLookaheadPages = 1;
+	_maximumNumberOfLoadedPages = 16;
+	_maximumNumberOfBatchUpdates = pageSize;
+	[self resetNumberOfItems];
+	return self;
+}
+
+- (void)resetNumberOfItems {
+	self.hasExactNumberOfItems = NO;
+	if ([self.backend respondsToSelector:@selector(estimatedNumberOfObjects)]) {
+		self.numberOfItems = [self.backend estimatedNumberOfObjects];
+	} else {
+		self.numberOfItems = self.pageSize;
+	}
+	self.numberOfDisplayedItems = self.numberOfItems;
+}
+
+- (void)reloadAllPages {
+	self.generation++;
+	[self.pages removeAllObjects];
+	[self.pendingPages removeAllIndexes];
+	[self.failedPages removeAllObjects];
+	[self.pageRetryTimes removeAllObjects];
+	[self resetNumberOfItems];
+	[self.collectionView reloadData];
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+	NSArray *page = self.pages[@(index / self.pageSize)];
+	NSUInteger indexInPage = index % self.pageSize;
+	return (indexInPage < page.count ? page[indexInPage] : nil);
+}
+
+#pragma mark Loading
+
+- (void)loadPagesAroundPage:(NSUInteger)pageIndex {
+	NSUInteger numberOfPages = (self.numberOfItems + self.pageSize - 1) / self.pageSize;
+	NSUInteger firstPage = (pageIndex > self.numberOfLookaheadPages ? pageIndex - self.numberOfLookaheadPages : 0);
+	NSUInteger lastPage = MIN(pageIndex + self.numberOfLookaheadPages, numberOfPages > 0 ? numberOfPages - 1 : 0);
+	
+	// The page being displayed is requested first, then the pages around it.
+	[self loadPage:pageIndex];
+	for (NSUInteger page = firstPage; page <= lastPage; page++) {
+		[self loadPage:page];
+	}
+}
+
+- (void)loadPage:(NSUInteger)pageIndex {
+	if (self.pages[@(pageIndex)] != nil || [self.pendingPages containsIndex:pageIndex])
+		return;
+	
+	// Pages that failed to load are left alone until their retry is due.
+	NSNumber *retryTime = self.pageRetryTimes[@(pageIndex)];
+	if (retryTime != nil && CACurrentMediaTime() < retryTime.doubleValue)
+		return;
+	
+	[self.pendingPages addIndex:pageIndex];
+	
+	NSRange range = NSMakeRange(pageIndex * self.pageSize, self.pageSize);
+	NSUInteger generation = self.generation;
+	__weak typeof(self) weakSelf = self;
+	[self.backend fetchObjectsInRange:range completionHandler:^(NSArray *objects, NSError *error) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			typeof(self) strongSelf = weakSelf;
+			if (strongSelf == nil || strongSelf.generation != generation)
+				return;
+			
+			[strongSelf.pendingPages removeIndex:pageIndex];
+			if (objects != nil) {
+				[strongSelf.failedPages removeObjectForKey:@(pageIndex)];
+				[strongSelf.pageRetryTimes removeObjectForKey:@(pageIndex)];
+				[strongSelf didLoadObjects:objects inRange:range];
+			} else {
+				[strongSelf didFailToLoadPage:pageIndex];
+			}
+		});
+	}];
+}
+
+- (void)didLoadObjects:(NSArray *)objects inRange:(NSRange)range {
+	NSUInteger pageIndex = range.location / self.pageSize;
+	self.pages[@(pageIndex)] = [objects copy];
+	
+	// A partial page marks the end of the data. A full page reaching the estimated end means
+	// that there's at least one more page.
+	NSUInteger numberOfItems = self.numberOfItems;
+	if (objects.count < range.length) {
+		if (!self.hasExactNumberOfItems || range.location + objects.count < numberOfItems) {
+			numberOfItems = range.location + objects.count;
+			self.hasExactNumberOfItems = YES;
+		}
+	} else if (!self.hasExactNumberOfItems && NSMaxRange(range) >= numberOfItems) {
+		numberOfItems = NSMaxRange(range) + self.pageSize;
+	}
+	
+	[self evictDistantPages];
+	
+	if (numberOfItems != self.numberOfItems) {
+		self.numberOfItems = numberOfItems;
+		[self updateNumberOfDisplayedItems];
+	}
+	
+	NSMutableArray *reloadedIndexPaths = [NSMutableArray array];
+	for (NSIndexPath *indexPath in [self.collectionView indexPathsForVisibleItems]) {
+		if (indexPath.jnw_section == 0 && NSLocationInRange(indexPath.jnw_item, range) && (NSUInteger)indexPath.jnw_item < self.numberOfDisplayedItems) {
+			[reloadedIndexPaths addObject:indexPath];
+		}
+	}
+	
+	if (reloadedIndexPaths.count > 0) {
+		[self.collectionView reloadItemsAtIndexPaths:reloadedIndexPaths];
+	}
+}
+
+/// Brings the collection view up to date with the number of items by inserting or deleting items at the end,
+/// which keeps the selection and everything else about the items that stay, unless the change is too large. Only one batch update runs at a
+/// time, and any change in the meantime is applied once it has finished.
+- (void)updateNumberOfDisplayedItems {
+	JNWCollectionView *collectionView = self.collectionView;
+	NSUInteger numberOfItems = self.numberOfItems;
+	NSUInteger numberOfDisplayedItems = self.numberOfDisplayedItems;
+	if (self.performingBatchUpdates || numberOfItems == numberOfDisplayedItems)
+		return;
+	
+	self.numberOfDisplayedItems = numberOfItems;
+	if (collectionView == nil)
+		return;
+	
+	// Every inserted or deleted item is mapped against the visible cells, so large corrections are cheaper as a reload.
+	if (MAX(numberOfItems, numberOfDisplayedItems) - MIN(numberOfItems, numberOfDisplayedItems) > self.maximumNumberOfBatchUpdates) {
+		[collectionView reloadData];
+		return;
+	}
+	
+	NSMutableArray *indexPaths = [NSMutableArray arrayWithCapacity:MAX(numberOfItems, numberOfDisplayedItems) - MIN(numberOfItems, numberOfDisplayedItems)];
+	for (NSUInteger item = MIN(numberOfItems, numberOfDisplayedItems); item < MAX(numberOfItems, numberOfDisplayedItems); item++) {
+		[indexPaths addObject:[NSIndexPath jnw_indexPathForItem:item inSection:0]];
+	}
+	
+	self.performingBatchUpdates = YES;
+	__weak typeof(self) weakSelf = self;
+	[collectionView performBatchUpdates:^{
+		if (numberOfItems > numberOfDisplayedItems) {
+			[collectionView insertItemsAtIndexPaths:indexPaths];
+		} else {
+			[collectionView deleteItemsAtIndexPaths:indexPaths];
+		}
+	} completion:^(BOOL finished) {
+		typeof(self) strongSelf = weakSelf;
+		strongSelf.performingBatchUpdates = NO;
+		[strongSelf updateNumberOfDisplayedItems];
+	}];
+}
+
+- (void)didFailToLoadPage:(NSUInteger)pageIndex {
+	NSUInteger numberOfFailures = [self.failedPages[@(pageIndex)] unsignedIntegerValue] + 1;
+	NSTimeInterval delay = MIN(JNWCollectionViewPagedDataSourceInitialRetryDelay * pow(2, numberOfFailures - 1), JNWCollectionViewPagedDataSourceMaximumRetryDelay);
+	self.failedPages[@(pageIndex)] = @(numberOfFailures);
+	self.pageRetryTimes[@(pageIndex)] = @(CACurrentMediaTime() + delay);
+	
+	// The placeholders of the page may stay on screen without their cells being requested again, so the page
+	// is retried by itself if it's still around the items being displayed by then.
+	NSUInteger generation = self.generation;
+	__weak typeof(self) weakSelf = self;
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+		typeof(self) strongSelf = weakSelf;
+		if (strongSelf == nil || strongSelf.generation != generation || strongSelf.failedPages[@(pageIndex)] == nil)
+			return;
+		
+		NSUInteger lastDisplayedPage = strongSelf.lastDisplayedPage;
+		NSUInteger distance = (pageIndex > lastDisplayedPage ? pageIndex - lastDisplayedPage : lastDisplayedPage - pageIndex);
+		if (distance <= strongSelf.numberOfLookaheadPages) {
+			[strongSelf.pageRetryTimes removeObjectForKey:@(pageIndex)];
+			[strongSelf loadPage:pageIndex];
+		}
+	});
+}
+
+- (void)evictDistantPages {
+	if (self.pages.count <= self.maximumNumberOfLoadedPages)
+		return;
+	
+	NSUInteger lastDisplayedPage = self.lastDisplayedPage;
+	NSArray *pageIndexes = [self.pages.allKeys sortedArrayUsingComparator:^NSComparisonResult(NSNumber *page1, NSNumber *page2) {
+		NSUInteger distance1 = ABS((NSInteger)page1.unsignedIntegerValue - (NSInteger)lastDisplayedPage);
+		NSUInteger distance2 = ABS((NSInteger)page2.unsignedIntegerValue - (NSInteger)lastDisplayedPage);
+		return [@(distance2) compare:@(distance1)];
+	}];
+	
+	NSUInteger numberOfEvictedPages = self.pages.count - self.maximumNumberOfLoadedPages;
+	[self.pages removeObjectsForKeys:[pageIndexes subarrayWithRange:NSMakeRange(0, numberOfEvictedPages)]];
+}
+
+#pragma mark JNWCollectionViewDataSource
+
+- (NSUInteger)collectionView:(JNWCollectionView *)collectionView numberOfItemsInSection:(NSInteger)section {
+	return self.numberOfDisplayedItems;
+}
+
+- (JNWCollectionViewCell *)collectionView:(JNWCollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath {
+	NSAssert(self.cellProvider != nil, @"a cell provider must be set on the paged data source");
+	
+	NSUInteger pageIndex = indexPath.jnw_item / self.pageSize;
+	self.lastDisplayedPage = pageIndex;
+	[self loadPagesAroundPage:pageIndex];
+	
+	return self.cellProvider(collectionView, indexPath, [self objectAtIndex:indexPath.jnw_item]);
+}
+
+@end
@@ -0,0 +1,84 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewFramework.h"
+
+/// Returns whether the item at the index in the source data source is included in the projection.
+typedef BOOL (^JNWCollectionViewProjectionFilter)(NSUInteger sourceIndex);
+
+/// Orders two items by their indexes in the source data source.
+typedef NSComparisonResult (^JNWCollectionViewProjectionComparator)(NSUInteger sourceIndex1, NSUInteger sourceIndex2);
+
+/// A data source which shows a filtered and optionally sorted subset of the items in the first section of
+/// another data source, without the other data source having to rebuild its model.
+///
+/// The projection keeps a vector mapping each displayed item to its index in the source. When the filter
+/// changes, the vector is recalculated in chunks on a background queue, so the filter and comparator must be
+/// safe to call from a background thread. If the new filter only ever matches items that the previous filter
+/// matched, such as when a search query gets longer, only the currently displayed items are filtered again.
+///
+/// Unsorted results are shown as each chunk completes, while sorted results are shown once sorting has
+/// finished. Small changes are applied to the collection view as batch updates, and larger ones reload it,
+/// which is cheapest with `recyclesViewsOnReload` enabled on the collection view.
+///
+/// All methods must be called from the main thread.
+@interface JNWCollectionViewProjection : NSObject <JNWCollectionViewDataSource>
+
+- (instancetype)initWithDataSource:(id<JNWCollectionViewDataSource>)dataSource;
+
+/// The data source whose items are projected. Only its first section is used.
+@property (nonatomic, unsafe_unretained, readonly) id<JNWCollectionViewDataSource> dataSource;
+
+/// The collection view which displays the projection. This must be set before the projection is set as its
+/// data source, and reads the number of items from the source.
+@property (nonatomic, unsafe_unretained) JNWCollectionView *collectionView;
+
+/// The current filter and comparator. Both are nil when all items are shown in their original order.
+@property (nonatomic, copy, readonly) JNWCollectionViewProjectionFilter filter;
+@property (nonatomic, copy, readonly) JNWCollectionViewProjectionComparator comparator;
+
+/// Starts recalculating the projection with the filter and comparator, cancelling any calculation already in
+/// progress. Pass nil for both to show all items again.
+///
+/// Pass YES for `refinesPreviousFilter` only if every item matched by the new filter was also matched by the
+/// previous one.
+- (void)setFilter:(JNWCollectionViewProjectionFilter)filter comparator:(JNWCollectionViewProjectionComparator)comparator refinesPreviousFilter:(BOOL)refinesPreviousFilter;
+
+/// Must be called when the items of the source data source change, instead of reloading the collection view.
+/// The current filter and comparator are applied to the new items.
+- (void)sourceDataDidChange;
+
+/// Whether the projection is still being calculated in the background.
+@property (nonatomic, assign, readonly, getter=isUpdating) BOOL updating;
+
+/// The number of items currently displayed.
+@property (nonatomic, assign, readonly) NSUInteger numberOfItems;
+
+/// Converts between indexes of displayed items and indexes in the source. Returns NSNotFound for a source
+/// index which isn't currently displayed.
+- (NSUInteger)sourceIndexForIndex:(NSUInteger)index;
+- (NSUInteger)indexForSourceIndex:(NSUInteger)sourceIndex;
+
+/// The largest number of inserted and deleted items that are applied as a batch update. Larger changes
+/// reload the collection view instead.
+///
+/// Defaults to 50.
+@property (nonatomic, assign) NSUInteger maximumNumberOfBatchUpdates;
+
+@end
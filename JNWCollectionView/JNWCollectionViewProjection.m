@@ -0,0 +1,430 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewProjection.h"
+
+// Large enough that posting each chunk to the main thread is cheap compared to filtering it.
+static const NSUInteger JNWCollectionViewProjectionChunkSize = 16384;
+
+// Each inserted or deleted item is animated and moves the cells after it, so the cost of a batch update
+// grows with the number of changes, while a reload with recycled views costs about the same as laying out
+// the visible cells once. Around a screenful of list rows is where the two cost about the same.
+static const NSUInteger JNWCollectionViewProjectionDefaultMaximumNumberOfBatchUpdates = 50;
+
+@interface JNWCollectionViewProjection()
+@property (nonatomic, copy, readwrite) JNWCollectionViewProjectionFilter filter;
+@property (nonatomic, copy, readwrite) JNWCollectionViewProjectionComparator comparator;
+@property (nonatomic, assign, readwrite, getter=isUpdating) BOOL updating;
+@property (nonatomic, strong) NSData *mapping; // source indexes of the displayed items, or nil if all items are displayed
+@property (nonatomic, assign) BOOL mappingIsOrdered; // YES if the source indexes are increasing
+@property (nonatomic, assign) NSUInteger numberOfSourceItems;
+@property (nonatomic, strong) NSOperationQueue *queue;
+@property (nonatomic, assign) BOOL performingBatchUpdates;
+@property (nonatomic, strong) NSData *pendingMapping;
+@property (nonatomic, assign) BOOL pendingMappingIsOrdered;
+@property (nonatomic, assign) BOOL hasPendingMapping;
+@property (nonatomic, assign) NSUInteger filterGeneration; // incremented for every new filter, so stale results can be told apart
+@property (nonatomic, strong) NSMutableData *streamedMapping; // the mapping unsorted results are being streamed into
+@property (nonatomic, assign) NSUInteger numberOfStreamedResults; // the leading entries of the streamed mapping that have been filtered
+@end
+
+@implementation JNWCollectionViewProjection
+
+- (instancetype)initWithDataSource:(id<JNWCollectionViewDataSource>)dataSource {
+	NSParameterAssert(dataSource);
+	
+	self = [super init];
+	if (self == nil) return nil;
+	_dataSource = dataSource;
+	_mappingIsOrdered = YES;
+	_maximumNumberOfBatchUpdates = JNWCollectionViewProjectionDefaultMaximumNumberOfBatchUpdates;
+	_queue = [[NSOperationQueue alloc] init];
+	_queue.maxConcurrentOperationCount = 1;
+	return self;
+}
+
+- (void)dealloc {
+	[_queue cancelAllOperations];
+}
+
+- (void)setCollectionView:(JNWCollectionView *)collectionView {
+	_collectionView = collectionView;
+	self.numberOfSourceItems = [self.dataSource collectionView:collectionView numberOfItemsInSection:0];
+}
+
+#pragma mark Mapping
+
+- (NSUInteger)numberOfItems {
+	return (self.mapping != nil ? self.mapping.length / sizeof(NSUInteger) : self.numberOfSourceItems);
+}
+
+- (NSUInteger)sourceIndexForIndex:(NSUInteger)index {
+	if (self.mapping == nil)
+		return index;
+	
+	NSAssert(index < self.numberOfItems, @"index %lu is out of bounds", (unsigned long)index);
+	const NSUInteger *sourceIndexes = self.mapping.bytes;
+	return sourceIndexes[index];
+}
+
+- (NSUInteger)indexForSourceIndex:(NSUInteger)sourceIndex {
+	if (self.mapping == nil)
+		return (sourceIndex < self.numberOfSourceItems ? sourceIndex : NSNotFound);
+	
+	const NSUInteger *sourceIndexes = self.mapping.bytes;
+	NSUInteger count = self.numberOfItems;
+	
+	if (self.mappingIsOrdered) {
+		NSUInteger low = 0;
+		NSUInteger high = count;
+		while (low < high) {
+			NSUInteger mid = low + (high - low) / 2;
+			if (sourceIndexes[mid] < sourceIndex) {
+				low = mid + 1;
+			} else {
+				high = mid;
+			}
+		}
+		return (low < count && sourceIndexes[low] == sourceIndex ? low : NSNotFound);
+	}
+	
+	for (NSUInteger index = 0; index < count; index++) {
+		if (sourceIndexes[index] == sourceIndex)
+			return index;
+	}
+	return NSNotFound;
+}
+
+#pragma mark Filtering
+
+- (void)sourceDataDidChange {
+	self.numberOfSourceItems = [self.dataSource collectionView:self.collectionView numberOfItemsInSection:0];
+	
+	if (self.filter == nil && self.comparator == nil) {
+		[self.queue cancelAllOperations];
+		self.filterGeneration++;
+		self.streamedMapping = nil;
+		self.updating = NO;
+		self.mapping = nil;
+		self.mappingIsOrdered = YES;
+		self.hasPendingMapping = NO;
+		[self.collectionView reloadData];
+	} else {
+		// The old mapping may refer to items which no longer exist, so it's replaced outright.
+		self.mapping = [NSData data];
+		self.mappingIsOrdered = YES;
+		[self.collectionView reloadData];
+		[self setFilter:self.filter comparator:self.comparator refinesPreviousFilter:NO];
+	}
+}
+
+- (void)setFilter:(JNWCollectionViewProjectionFilter)filter comparator:(JNWCollectionViewProjectionComparator)comparator refinesPreviousFilter:(BOOL)refinesPreviousFilter {
+	[self.queue cancelAllOperations];
+	self.filter = filter;
+	self.comparator = comparator;
+	
+	// Results already on their way to the main queue from an earlier filter are dropped by comparing
+	// generations, since a cancelled operation may be gone by the time they arrive.
+	NSUInteger generation = ++self.filterGeneration;
+	self.streamedMapping = nil;
+	self.numberOfStreamedResults = 0;
+	
+	if (filter == nil && comparator == nil) {
+		self.updating = NO;
+		[self applyMapping:nil ordered:YES];
+		return;
+	}
+	
+	// A refinement only has to look at the items displayed now, as long as they're in an order that the new
+	// result can use: the source order, or any order if the result is going to be sorted anyway.
+	NSData *currentMapping = (self.hasPendingMapping ? self.pendingMapping : self.mapping);
+	BOOL currentMappingIsOrdered = (self.hasPendingMapping ? self.pendingMappingIsOrdered : self.mappingIsOrdered);
+	NSData *candidates = nil;
+	if (refinesPreviousFilter && currentMapping != nil && (currentMappingIsOrdered || comparator != nil)) {
+		candidates = currentMapping;
+	}
+	NSUInteger numberOfCandidates = (candidates != nil ? candidates.length / sizeof(NSUInteger) : self.numberOfSourceItems);
+	
+	// Unsorted results of a refinement replace the candidates in place, chunk by chunk, in a copy of the
+	// mapping, while the background operation reads the original.
+	if (comparator == nil && candidates != nil) {
+		self.streamedMapping = [candidates mutableCopy];
+		if (self.hasPendingMapping) {
+			self.pendingMapping = self.streamedMapping;
+		} else {
+			self.mapping = self.streamedMapping;
+		}
+	}
+	
+	self.updating = YES;
+	
+	NSBlockOperation *operation = [[NSBlockOperation alloc] init];
+	__weak NSBlockOperation *weakOperation = operation;
+	__weak typeof(self) weakSelf = self;
+	
+	// Only the matches of each chunk are posted, along with the number of candidates they replace.
+	void (^postMatches)(NSData *, NSUInteger, BOOL) = ^(NSData *matches, NSUInteger numberOfReplacedCandidates, BOOL finished) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			typeof(self) strongSelf = weakSelf;
+			if (strongSelf == nil || strongSelf.filterGeneration != generation)
+				return;
+			
+			[strongSelf applyStreamedMatches:matches replacingNumberOfCandidates:numberOfReplacedCandidates];
+			if (finished) {
+				strongSelf.updating = NO;
+			}
+		});
+	};
+	
+	void (^postSortedResults)(NSData *) = ^(NSData *results) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			typeof(self) strongSelf = weakSelf;
+			if (strongSelf == nil || strongSelf.filterGeneration != generation)
+				return;
+			
+			[strongSelf applyMapping:results ordered:NO];
+			strongSelf.updating = NO;
+		});
+	};
+	
+	[operation addExecutionBlock:^{
+		const NSUInteger *candidateIndexes = candidates.bytes;
+		NSMutableData *results = (comparator != nil ? [NSMutableData dataWithCapacity:numberOfCandidates * sizeof(NSUInteger)] : nil);
+		
+		for (NSUInteger start = 0; start < numberOfCandidates || start == 0; start += JNWCollectionViewProjectionChunkSize) {
+			if (weakOperation.isCancelled)
+				return;
+			
+			NSUInteger end = MIN(start + JNWCollectionViewProjectionChunkSize, numberOfCandidates);
+			NSMutableData *matches = (comparator == nil ? [NSMutableData data] : results);
+			for (NSUInteger idx = start; idx < end; idx++) {
+				NSUInteger sourceIndex = (candidateIndexes != NULL ? candidateIndexes[idx] : idx);
+				if (filter == nil || filter(sourceIndex)) {
+					[matches appendBytes:&sourceIndex length:sizeof(NSUInteger)];
+				}
+			}
+			
+			// Unsorted results are shown as they come in. For a refinement, the candidates which haven't been
+			// filtered yet stay displayed until their chunk is reached.
+			if (comparator == nil) {
+				postMatches(matches, (candidateIndexes != NULL ? end - start : 0), end == numberOfCandidates);
+			}
+			
+			if (end == numberOfCandidates)
+				break;
+		}
+		
+		if (comparator != nil) {
+			qsort_b(results.mutableBytes, results.length / sizeof(NSUInteger), sizeof(NSUInteger), ^int(const void *a, const void *b) {
+				return (int)comparator(*(const NSUInteger *)a, *(const NSUInteger *)b);
+			});
+			
+			if (!weakOperation.isCancelled) {
+				postSortedResults(results);
+			}
+		}
+	}];
+	
+	[self.queue addOperation:operation];
+}
+
+#pragma mark Updating
+
+- (void)applyMapping:(NSData *)mapping ordered:(BOOL)ordered {
+	// Only a single batch update can run at a time, so results arriving in the meantime are coalesced.
+	if (self.performingBatchUpdates) {
+		self.pendingMapping = mapping;
+		self.pendingMappingIsOrdered = ordered;
+		self.hasPendingMapping = YES;
+		return;
+	}
+	
+	NSData *oldMapping = self.mapping;
+	NSUInteger oldNumberOfItems = self.numberOfItems;
+	BOOL oldMappingIsOrdered = self.mappingIsOrdered;
+	
+	self.mapping = mapping;
+	self.mappingIsOrdered = ordered;
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	if (collectionView == nil)
+		return;
+	
+	NSMutableArray *deletedIndexPaths = [NSMutableArray array];
+	NSMutableArray *insertedIndexPaths = [NSMutableArray array];
+	BOOL canBatch = (oldMappingIsOrdered && ordered &&
+					 [self findChangesFromMapping:oldMapping count:oldNumberOfItems toMapping:mapping count:self.numberOfItems deletedIndexPaths:deletedIndexPaths insertedIndexPaths:insertedIndexPaths]);
+	
+	if (!canBatch) {
+		[collectionView reloadData];
+		return;
+	}
+	
+	[self performBatchUpdatesDeletingItemsAtIndexPaths:deletedIndexPaths insertingItemsAtIndexPaths:insertedIndexPaths];
+}
+
+/// Applies the matches of a chunk of unsorted results to the streamed mapping. The matches replace the given
+/// number of candidates following the results streamed so far, or are appended if there are no candidates.
+- (void)applyStreamedMatches:(NSData *)matches replacingNumberOfCandidates:(NSUInteger)numberOfCandidates {
+	NSUInteger numberOfMatches = matches.length / sizeof(NSUInteger);
+	NSMutableData *mapping = self.streamedMapping;
+	
+	// The first chunk of a new filter replaces whatever was displayed before.
+	if (mapping == nil) {
+		self.streamedMapping = [matches mutableCopy];
+		self.numberOfStreamedResults = numberOfMatches;
+		[self applyMapping:self.streamedMapping ordered:YES];
+		return;
+	}
+	
+	NSUInteger start = self.numberOfStreamedResults;
+	NSRange replacedRange = NSMakeRange(start * sizeof(NSUInteger), numberOfCandidates * sizeof(NSUInteger));
+	self.numberOfStreamedResults += numberOfMatches;
+	
+	// The mapping the collection view is displaying can't change while a batch update runs, so the chunk goes
+	// into the pending mapping, which is compared against the displayed one once the update has finished.
+	if (self.performingBatchUpdates) {
+		if (!self.hasPendingMapping || self.pendingMapping != mapping) {
+			mapping = [mapping mutableCopy];
+			self.streamedMapping = mapping;
+			self.pendingMapping = mapping;
+			self.pendingMappingIsOrdered = YES;
+			self.hasPendingMapping = YES;
+		}
+		[mapping replaceBytesInRange:replacedRange withBytes:matches.bytes length:matches.length];
+		return;
+	}
+	
+	// Only the changed range is compared: the matches are a subsequence of the candidates they replace, and
+	// without candidates they're added to the end.
+	NSMutableArray *deletedIndexPaths = [NSMutableArray array];
+	NSMutableArray *insertedIndexPaths = [NSMutableArray array];
+	if (numberOfCandidates == 0) {
+		for (NSUInteger idx = 0; idx < numberOfMatches; idx++) {
+			[insertedIndexPaths addObject:[NSIndexPath jnw_indexPathForItem:start + idx inSection:0]];
+		}
+	} else {
+		const NSUInteger *candidateIndexes = (const NSUInteger *)mapping.bytes + start;
+		const NSUInteger *matchIndexes = matches.bytes;
+		NSUInteger matchIdx = 0;
+		for (NSUInteger candidateIdx = 0; candidateIdx < numberOfCandidates; candidateIdx++) {
+			if (matchIdx < numberOfMatches && matchIndexes[matchIdx] == candidateIndexes[candidateIdx]) {
+				matchIdx++;
+			} else {
+				[deletedIndexPaths addObject:[NSIndexPath jnw_indexPathForItem:start + candidateIdx inSection:0]];
+			}
+		}
+	}
+	
+	[mapping replaceBytesInRange:replacedRange withBytes:matches.bytes length:matches.length];
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	if (collectionView == nil)
+		return;
+	
+	if (deletedIndexPaths.count + insertedIndexPaths.count > self.maximumNumberOfBatchUpdates) {
+		[collectionView reloadData];
+		return;
+	}
+	
+	[self performBatchUpdatesDeletingItemsAtIndexPaths:deletedIndexPaths insertingItemsAtIndexPaths:insertedIndexPaths];
+}
+
+- (void)performBatchUpdatesDeletingItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertingItemsAtIndexPaths:(NSArray *)insertedIndexPaths {
+	if (deletedIndexPaths.count == 0 && insertedIndexPaths.count == 0)
+		return;
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	self.performingBatchUpdates = YES;
+	__weak typeof(self) weakSelf = self;
+	[collectionView performBatchUpdates:^{
+		[collectionView deleteItemsAtIndexPaths:deletedIndexPaths];
+		[collectionView insertItemsAtIndexPaths:insertedIndexPaths];
+	} completion:^(BOOL finished) {
+		typeof(self) strongSelf = weakSelf;
+		strongSelf.performingBatchUpdates = NO;
+		if (strongSelf.hasPendingMapping) {
+			strongSelf.hasPendingMapping = NO;
+			[strongSelf applyMapping:strongSelf.pendingMapping ordered:strongSelf.pendingMappingIsOrdered];
+			strongSelf.pendingMapping = nil;
+		}
+	}];
+}
+
+/// Finds the deleted and inserted items between two mappings in source order by merging them. Returns NO as
+/// soon as there are more changes than can be applied as a batch update.
+- (BOOL)findChangesFromMapping:(NSData *)oldMapping count:(NSUInteger)oldCount toMapping:(NSData *)newMapping count:(NSUInteger)newCount deletedIndexPaths:(NSMutableArray *)deletedIndexPaths insertedIndexPaths:(NSMutableArray *)insertedIndexPaths {
+	NSUInteger maximumNumberOfChanges = self.maximumNumberOfBatchUpdates;
+	if (MAX(oldCount, newCount) - MIN(oldCount, newCount) > maximumNumberOfChanges)
+		return NO;
+	
+	// A nil mapping displays every source item in order.
+	const NSUInteger *oldIndexes = oldMapping.bytes;
+	const NSUInteger *newIndexes = newMapping.bytes;
+	NSUInteger oldIdx = 0;
+	NSUInteger newIdx = 0;
+	
+	while (oldIdx < oldCount || newIdx < newCount) {
+		NSUInteger oldSourceIndex = (oldIdx < oldCount ? (oldMapping != nil ? oldIndexes[oldIdx] : oldIdx) : NSUIntegerMax);
+		NSUInteger newSourceIndex = (newIdx < newCount ? (newMapping != nil ? newIndexes[newIdx] : newIdx) : NSUIntegerMax);
+		
+		if (oldSourceIndex == newSourceIndex) {
+			oldIdx++;
+			newIdx++;
+		} else if (oldSourceIndex < newSourceIndex) {
+			[deletedIndexPaths addObject:[NSIndexPath jnw_indexPathForItem:oldIdx++ inSection:0]];
+		} else {
+			[insertedIndexPaths addObject:[NSIndexPath jnw_indexPathForItem:newIdx++ inSection:0]];
+		}
+		
+		if (deletedIndexPaths.count + insertedIndexPaths.count > maximumNumberOfChanges)
+			return NO;
+	}
+	
+	return YES;
+}
+
+#pragma mark JNWCollectionViewDataSource
+
+- (NSInteger)numberOfSectionsInCollectionView:(JNWCollectionView *)collectionView {
+	return 1;
+}
+
+- (NSUInteger)collectionView:(JNWCollectionView *)collectionView numberOfItemsInSection:(NSInteger)section {
+	return self.numberOfItems;
+}
+
+- (JNWCollectionViewCell *)collectionView:(JNWCollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath {
+	NSIndexPath *sourceIndexPath = [NSIndexPath jnw_indexPathForItem:[self sourceIndexForIndex:indexPath.jnw_item] inSection:0];
+	return [self.dataSource collectionView:collectionView cellForItemAtIndexPath:sourceIndexPath];
+}
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+	// Supplementary views are only available if the source provides them.
+	if (aSelector == @selector(collectionView:viewForSupplementaryViewOfKind:inSection:)) {
+		return [self.dataSource respondsToSelector:aSelector];
+	}
+	return [super respondsToSelector:aSelector];
+}
+
+- (JNWCollectionViewReusableView *)collectionView:(JNWCollectionView *)collectionView viewForSupplementaryViewOfKind:(NSString *)kind inSection:(NSInteger)section {
+	return [self.dataSource collectionView:collectionView viewForSupplementaryViewOfKind:kind inSection:section];
+}
+
+@end
@@ -0,0 +1,43 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewReusePool.h"
+
+@class JNWCollectionViewCell;
+@class JNWCollectionViewReusableView;
+
+@interface JNWCollectionViewReusePool ()
+
+- (JNWCollectionViewCell *)dequeueCellWithIdentifier:(NSString *)identifier;
+
+/// Returns NO if the pool is full for the identifier, in which case the cell is not added.
+- (BOOL)enqueueCell:(JNWCollectionViewCell *)cell withIdentifier:(NSString *)identifier;
+
+/// Takes the cell out of the pool. Returns NO if the cell wasn't in it, for example because it was
+/// dequeued in the meantime, in which case it must not be used.
+- (BOOL)removeCell:(JNWCollectionViewCell *)cell withIdentifier:(NSString *)identifier;
+
+/// Supplementary views are pooled under the identifier formed from their kind and reuse identifier,
+/// and are limited by the limit of the reuse identifier alone.
+- (JNWCollectionViewReusableView *)dequeueSupplementaryViewWithIdentifier:(NSString *)identifier;
+- (BOOL)enqueueSupplementaryView:(JNWCollectionViewReusableView *)view withIdentifier:(NSString *)identifier reuseIdentifier:(NSString *)reuseIdentifier;
+
+- (void)enumerateCellsUsingBlock:(void (^)(JNWCollectionViewCell *cell))block;
+
+@end
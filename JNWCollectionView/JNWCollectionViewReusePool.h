@@ -0,0 +1,51 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import <Cocoa/Cocoa.h>
+
+/// A pool of cells and supplementary views waiting to be reused, which can be shared by several
+/// collection views displaying the same kinds of views, such as the panes of a split view.
+///
+/// Every collection view has a pool of its own by default. Assigning the same pool to several
+/// collection views lets a view that scrolls out of one of them be reused by any of the others,
+/// so that the number of views kept around doesn't grow with the number of collection views. The
+/// collection views sharing a pool should register the same classes or nibs for each identifier.
+///
+/// All methods must be called from the main thread.
+@interface JNWCollectionViewReusePool : NSObject
+
+/// The maximum number of views kept for each reuse identifier, unless a limit has been set for the
+/// identifier itself. Views enqueued beyond the limit are discarded.
+///
+/// Defaults to NSUIntegerMax.
+@property (nonatomic, assign) NSUInteger maximumNumberOfViewsPerIdentifier;
+
+/// Sets the maximum number of views kept for the reuse identifier, which applies to cells and to
+/// supplementary views of any kind using the identifier. Lowering the limit immediately discards
+/// views until the pool fits.
+- (void)setMaximumNumberOfViews:(NSUInteger)maximumNumberOfViews forReuseIdentifier:(NSString *)reuseIdentifier;
+- (NSUInteger)maximumNumberOfViewsForReuseIdentifier:(NSString *)reuseIdentifier;
+
+/// The number of cells and supplementary views currently waiting to be reused.
+@property (nonatomic, assign, readonly) NSUInteger numberOfViews;
+
+/// Discards all of the views in the pool.
+- (void)removeAllViews;
+
+@end
@@ -0,0 +1,189 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewReusePool+Private.h"
+#import "JNWCollectionViewCell.h"
+#import "JNWCollectionViewReusableView.h"
+
+@interface JNWCollectionViewReusePool()
+@property (nonatomic, strong) NSMutableDictionary *cells; // { identifier : (cells) }
+@property (nonatomic, strong) NSMutableDictionary *supplementaryViews; // { "kind/identifier" : (views) }
+@property (nonatomic, strong) NSMutableDictionary *supplementaryViewReuseIdentifiers; // { "kind/identifier" : identifier }
+@property (nonatomic, strong) NSMutableDictionary *maximumNumberOfViewsByIdentifier; // { identifier : count }
+@end
+
+@implementation JNWCollectionViewReusePool
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_maximumNumberOfViewsPerIdentifier = NSUIntegerMax;
+	_cells = [NSMutableDictionary dictionary];
+	_supplementaryViews = [NSMutableDictionary dictionary];
+	_supplementaryViewReuseIdentifiers = [NSMutableDictionary dictionary];
+	_maximumNumberOfViewsByIdentifier = [NSMutableDictionary dictionary];
+	
+	return self;
+}
+
+#pragma mark Limits
+
+- (void)setMaximumNumberOfViewsPerIdentifier:(NSUInteger)maximumNumberOfViewsPerIdentifier {
+	_maximumNumberOfViewsPerIdentifier = maximumNumberOfViewsPerIdentifier;
+	[self trimToFitLimits];
+}
+
+- (void)setMaximumNumberOfViews:(NSUInteger)maximumNumberOfViews forReuseIdentifier:(NSString *)reuseIdentifier {
+	NSParameterAssert(reuseIdentifier);
+	self.maximumNumberOfViewsByIdentifier[reuseIdentifier] = @(maximumNumberOfViews);
+	[self trimToFitLimits];
+}
+
+- (NSUInteger)maximumNumberOfViewsForReuseIdentifier:(NSString *)reuseIdentifier {
+	NSNumber *maximumNumberOfViews = self.maximumNumberOfViewsByIdentifier[reuseIdentifier];
+	return (maximumNumberOfViews != nil ? maximumNumberOfViews.unsignedIntegerValue : self.maximumNumberOfViewsPerIdentifier);
+}
+
+- (void)trimToFitLimits {
+	[self.cells enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSMutableArray *cells, BOOL *stop) {
+		[self trimViews:cells toCount:[self maximumNumberOfViewsForReuseIdentifier:identifier]];
+	}];
+	[self.supplementaryViews enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, NSMutableArray *views, BOOL *stop) {
+		NSString *reuseIdentifier = self.supplementaryViewReuseIdentifiers[identifier];
+		[self trimViews:views toCount:[self maximumNumberOfViewsForReuseIdentifier:reuseIdentifier]];
+	}];
+}
+
+- (void)trimViews:(NSMutableArray *)views toCount:(NSUInteger)count {
+	// The views enqueued first are discarded first, as they are the least likely to still be in a
+	// window that is being displayed.
+	while (views.count > count) {
+		[self discardView:views.firstObject];
+		[views removeObjectAtIndex:0];
+	}
+}
+
+- (void)discardView:(NSView *)view {
+	// Cells, and supplementary views recycled on reload, wait in the reuse queue hidden in the
+	// document view they were last displayed in.
+	[view removeFromSuperview];
+}
+
+#pragma mark Cells
+
+- (JNWCollectionViewCell *)dequeueCellWithIdentifier:(NSString *)identifier {
+	return [self dequeueViewWithIdentifier:identifier inViews:self.cells];
+}
+
+- (BOOL)enqueueCell:(JNWCollectionViewCell *)cell withIdentifier:(NSString *)identifier {
+	return [self enqueueView:cell withIdentifier:identifier maximumNumberOfViews:[self maximumNumberOfViewsForReuseIdentifier:identifier] inViews:self.cells];
+}
+
+- (BOOL)removeCell:(JNWCollectionViewCell *)cell withIdentifier:(NSString *)identifier {
+	if (identifier == nil)
+		return NO;
+	
+	NSMutableArray *cells = self.cells[identifier];
+	NSUInteger index = [cells indexOfObjectIdenticalTo:cell];
+	if (index == NSNotFound)
+		return NO;
+	
+	[cells removeObjectAtIndex:index];
+	return YES;
+}
+
+- (void)enumerateCellsUsingBlock:(void (^)(JNWCollectionViewCell *))block {
+	for (NSArray *cells in self.cells.allValues) {
+		for (JNWCollectionViewCell *cell in cells) {
+			block(cell);
+		}
+	}
+}
+
+#pragma mark Supplementary views
+
+- (JNWCollectionViewReusableView *)dequeueSupplementaryViewWithIdentifier:(NSString *)identifier {
+	return [self dequeueViewWithIdentifier:identifier inViews:self.supplementaryViews];
+}
+
+- (BOOL)enqueueSupplementaryView:(JNWCollectionViewReusableView *)view withIdentifier:(NSString *)identifier reuseIdentifier:(NSString *)reuseIdentifier {
+	if (identifier == nil || reuseIdentifier == nil)
+		return NO;
+	
+	self.supplementaryViewReuseIdentifiers[identifier] = reuseIdentifier;
+	return [self enqueueView:view withIdentifier:identifier maximumNumberOfViews:[self maximumNumberOfViewsForReuseIdentifier:reuseIdentifier] inViews:self.supplementaryViews];
+}
+
+#pragma mark Pool
+
+- (id)dequeueViewWithIdentifier:(NSString *)identifier inViews:(NSDictionary *)views {
+	if (identifier == nil)
+		return nil;
+	
+	NSMutableArray *reusableViews = views[identifier];
+	id view = reusableViews.lastObject;
+	if (view != nil) {
+		[reusableViews removeLastObject];
+	}
+	return view;
+}
+
+- (BOOL)enqueueView:(NSView *)view withIdentifier:(NSString *)identifier maximumNumberOfViews:(NSUInteger)maximumNumberOfViews inViews:(NSMutableDictionary *)views {
+	if (identifier == nil)
+		return NO;
+	
+	NSMutableArray *reusableViews = views[identifier];
+	if (reusableViews == nil) {
+		reusableViews = [NSMutableArray array];
+		views[identifier] = reusableViews;
+	}
+	
+	if (reusableViews.count >= maximumNumberOfViews)
+		return NO;
+	
+	[reusableViews addObject:view];
+	return YES;
+}
+
+- (NSUInteger)numberOfViews {
+	NSUInteger numberOfViews = 0;
+	for (NSArray *cells in self.cells.allValues) {
+		numberOfViews += cells.count;
+	}
+	for (NSArray *views in self.supplementaryViews.allValues) {
+		numberOfViews += views.count;
+	}
+	return numberOfViews;
+}
+
+- (void)removeAllViews {
+	[self enumerateCellsUsingBlock:^(JNWCollectionViewCell *cell) {
+		[self discardView:cell];
+	}];
+	for (NSArray *views in self.supplementaryViews.allValues) {
+		for (NSView *view in views) {
+			[self discardView:view];
+		}
+	}
+	[self.cells removeAllObjects];
+	[self.supplementaryViews removeAllObjects];
+}
+
+@end
@@ -0,0 +1,52 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/// The offsets of a list of stacked sections, stored as a binary indexed tree over their heights.
+///
+/// Changing the height of a single section and looking up the offset of a section or the section at
+/// an offset are all logarithmic in the number of sections, so that a section can grow or shrink
+/// without the offsets of the sections after it being recalculated.
+@interface JNWCollectionViewSectionOffsets : NSObject
+
+/// Creates the offsets for sections with the given heights, in linear time.
+- (instancetype)initWithHeights:(const CGFloat *)heights count:(NSUInteger)count;
+
+/// The number of sections.
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// The sum of the heights of all sections.
+@property (nonatomic, assign, readonly) CGFloat totalHeight;
+
+- (CGFloat)heightOfSection:(NSUInteger)section;
+- (void)setHeight:(CGFloat)height ofSection:(NSUInteger)section;
+
+/// Replaces the heights of all sections at once, in linear time.
+- (void)setHeights:(const CGFloat *)heights;
+
+/// Returns the sum of the heights of the sections before the section.
+- (CGFloat)offsetOfSection:(NSUInteger)section;
+
+/// Returns the index of the last section starting at or above the offset, or NSNotFound if the
+/// offset is above the first section or there are no sections.
+- (NSInteger)sectionAtOffset:(CGFloat)offset;
+
+@end
@@ -0,0 +1,116 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+
+#import "JNWCollectionViewSectionOffsets.h"
+
+@implementation JNWCollectionViewSectionOffsets {
+	CGFloat *_heights;
+	CGFloat *_tree; // 1-based, each node holds the sum of the heights in its range
+	NSUInteger _highestPowerOfTwo;
+}
+
+- (instancetype)initWithHeights:(const CGFloat *)heights count:(NSUInteger)count {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_count = count;
+	_heights = calloc(MAX(count, 1), sizeof(CGFloat));
+	_tree = calloc(count + 1, sizeof(CGFloat));
+	
+	_highestPowerOfTwo = 1;
+	while (_highestPowerOfTwo * 2 <= count) {
+		_highestPowerOfTwo *= 2;
+	}
+	
+	[self setHeights:heights];
+	return self;
+}
+
+- (void)dealloc {
+	free(_heights);
+	free(_tree);
+}
+
+- (void)setHeights:(const CGFloat *)heights {
+	memcpy(_heights, heights, _count * sizeof(CGFloat));
+	
+	// Builds the tree bottom-up, by adding every node into its parent once it is complete.
+	for (NSUInteger idx = 1; idx <= _count; idx++) {
+		_tree[idx] = _heights[idx - 1];
+	}
+	for (NSUInteger idx = 1; idx <= _count; idx++) {
+		NSUInteger parent = idx + (idx & -idx);
+		if (parent <= _count) {
+			_tree[parent] += _tree[idx];
+		}
+	}
+}
+
+- (CGFloat)heightOfSection:(NSUInteger)section {
+	NSParameterAssert(section < _count);
+	return _heights[section];
+}
+
+- (void)setHeight:(CGFloat)height ofSection:(NSUInteger)section {
+	NSParameterAssert(section < _count);
+	
+	CGFloat delta = height - _heights[section];
+	if (delta == 0)
+		return;
+	
+	_heights[section] = height;
+	for (NSUInteger idx = section + 1; idx <= _count; idx += (idx & -idx)) {
+		_tree[idx] += delta;
+	}
+}
+
+- (CGFloat)offsetOfSection:(NSUInteger)section {
+	NSParameterAssert(section <= _count);
+	
+	CGFloat offset = 0;
+	for (NSUInteger idx = section; idx > 0; idx -= (idx & -idx)) {
+		offset += _tree[idx];
+	}
+	return offset;
+}
+
+- (CGFloat)totalHeight {
+	return [self offsetOfSection:_count];
+}
+
+- (NSInteger)sectionAtOffset:(CGFloat)offset {
+	if (_count == 0 || offset < 0)
+		return NSNotFound;
+	
+	// Descends the tree to find the largest number of leading sections whose heights add up to
+	// no more than the offset. That is the index of the last section starting at or above it.
+	NSUInteger position = 0;
+	CGFloat remaining = offset;
+	for (NSUInteger step = _highestPowerOfTwo; step > 0; step /= 2) {
+		if (position + step <= _count && _tree[position + step] <= remaining) {
+			position += step;
+			remaining -= _tree[position];
+		}
+	}
+	
+	return MIN(position, _count - 1);
+}
+
+@end
@@ -0,0 +1,62 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import <Cocoa/Cocoa.h>
+
+@class CALayer;
+@class JNWCollectionViewCell;
+
+/// Renders the layer tree into a new bitmap of the size in points at the scale, flipping the
+/// context for layers with flipped contents so that the image is upright either way.
+/// Returns NULL if the bitmap could not be created.
+extern CGImageRef JNWCollectionViewCreateImageOfLayer(CALayer *layer, CGSize size, CGFloat scale) CF_RETURNS_RETAINED;
+
+/// Rasterized snapshots of cells, keyed by the index path of the item they were taken of.
+///
+/// Snapshots are taken at the backing scale of the cell's window and are only returned for an
+/// item when its size, selection state and object value are still those at the time of the
+/// snapshot. Once the total cost exceeds `totalCostLimit`, the least recently used snapshots are
+/// evicted.
+@interface JNWCollectionViewSnapshotCache : NSObject
+
+/// The maximum total cost, in bytes of pixel data, of the snapshots held by the cache. Lowering
+/// the limit immediately evicts snapshots until the cache fits.
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/// The total cost of the snapshots currently held by the cache.
+@property (nonatomic, assign, readonly) NSUInteger totalCost;
+
+/// Returns the snapshot of the item at the index path, or NULL if there is none or it was taken
+/// at a different size or selection state, or of a cell showing a different object value.
+- (CGImageRef)snapshotForItemAtIndexPath:(NSIndexPath *)indexPath size:(CGSize)size selected:(BOOL)selected objectValue:(id)objectValue;
+
+/// Renders the cell's layer tree and stores the result as the snapshot of the item at the
+/// index path, replacing any previous snapshot. The cell's object value is kept with it.
+- (void)addSnapshotOfCell:(JNWCollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath;
+
+- (void)removeSnapshotsForItemsAtIndexPaths:(NSArray *)indexPaths;
+
+/// Moves the snapshots of the items following deleted or inserted items to their new index paths,
+/// the same way the selection follows its items. The deleted items are removed first, then the
+/// inserted ones are added, each relative to the index paths in effect at that point.
+- (void)shiftSnapshotsForDeletedItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertedItemsAtIndexPaths:(NSArray *)insertedIndexPaths;
+
+- (void)removeAllSnapshots;
+
+@end
@@ -0,0 +1,175 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewSnapshotCache.h"
+#import "JNWCollectionViewCell.h"
+#import "JNWCollectionViewLRUCache.h"
+#import "NSIndexPath+JNWAdditions.h"
+#import <QuartzCore/QuartzCore.h>
+
+// A rendered cell and the state it was rendered in.
+@interface JNWSnapshotCacheEntry : NSObject
+@property (nonatomic, strong) id image; // CGImageRef
+@property (nonatomic, assign) CGSize size;
+@property (nonatomic, assign) BOOL selected;
+@property (nonatomic, strong) id objectValue;
+@end
+
+@implementation JNWSnapshotCacheEntry
+@end
+
+CGImageRef JNWCollectionViewCreateImageOfLayer(CALayer *layer, CGSize size, CGFloat scale) {
+	size_t width = (size_t)ceil(size.width * scale);
+	size_t height = (size_t)ceil(size.height * scale);
+	if (layer == nil || width == 0 || height == 0)
+		return NULL;
+	
+	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+	CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host);
+	CGColorSpaceRelease(colorSpace);
+	if (context == NULL)
+		return NULL;
+	
+	if (layer.contentsAreFlipped) {
+		CGContextTranslateCTM(context, 0, height);
+		CGContextScaleCTM(context, 1, -1);
+	}
+	CGContextScaleCTM(context, scale, scale);
+	[layer renderInContext:context];
+	
+	CGImageRef image = CGBitmapContextCreateImage(context);
+	CGContextRelease(context);
+	return image;
+}
+
+@interface JNWCollectionViewSnapshotCache()
+@property (nonatomic, strong) JNWCollectionViewLRUCache *entries; // { index path : entry }
+@end
+
+@implementation JNWCollectionViewSnapshotCache
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_entries = [[JNWCollectionViewLRUCache alloc] init];
+	
+	return self;
+}
+
+- (NSUInteger)totalCostLimit {
+	return self.entries.totalCostLimit;
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+	self.entries.totalCostLimit = totalCostLimit;
+}
+
+- (NSUInteger)totalCost {
+	return self.entries.totalCost;
+}
+
+#pragma mark Snapshots
+
+- (CGImageRef)snapshotForItemAtIndexPath:(NSIndexPath *)indexPath size:(CGSize)size selected:(BOOL)selected objectValue:(id)objectValue {
+	JNWSnapshotCacheEntry *entry = [self.entries objectForKey:indexPath];
+	if (entry == nil || !CGSizeEqualToSize(entry.size, size) || entry.selected != selected || entry.objectValue != objectValue)
+		return NULL;
+	
+	return (__bridge CGImageRef)entry.image;
+}
+
+- (void)addSnapshotOfCell:(JNWCollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath {
+	NSParameterAssert(indexPath != nil);
+	
+	CALayer *layer = cell.layer;
+	CGSize size = cell.bounds.size;
+	CGFloat scale = cell.window.backingScaleFactor ?: 1;
+	size_t width = (size_t)ceil(size.width * scale);
+	size_t height = (size_t)ceil(size.height * scale);
+	if (layer == nil || width == 0 || height == 0)
+		return;
+	
+	// Snapshots larger than the whole cache would only evict everything else on the way in.
+	NSUInteger cost = width * height * 4;
+	if (cost > self.totalCostLimit)
+		return;
+	
+	CGImageRef image = JNWCollectionViewCreateImageOfLayer(layer, size, scale);
+	if (image == NULL)
+		return;
+	
+	JNWSnapshotCacheEntry *entry = [[JNWSnapshotCacheEntry alloc] init];
+	entry.image = CFBridgingRelease(image);
+	entry.size = size;
+	entry.selected = cell.selected;
+	entry.objectValue = cell.objectValue;
+	[self.entries setObject:entry forKey:indexPath cost:cost];
+}
+
+- (void)removeSnapshotsForItemsAtIndexPaths:(NSArray *)indexPaths {
+	for (NSIndexPath *indexPath in indexPaths) {
+		[self.entries removeObjectForKey:indexPath];
+	}
+}
+
+- (void)shiftSnapshotsForDeletedItemsAtIndexPaths:(NSArray *)deletedIndexPaths insertedItemsAtIndexPaths:(NSArray *)insertedIndexPaths {
+	if (deletedIndexPaths.count == 0 && insertedIndexPaths.count == 0)
+		return;
+	
+	NSDictionary *deletedItems = [self itemsBySectionForIndexPaths:deletedIndexPaths];
+	NSDictionary *insertedItems = [self itemsBySectionForIndexPaths:insertedIndexPaths];
+	
+	[self.entries rekeyObjectsUsingBlock:^id<NSCopying>(NSIndexPath *indexPath) {
+		NSInteger section = indexPath.jnw_section;
+		NSUInteger item = (NSUInteger)indexPath.jnw_item;
+		
+		NSIndexSet *deletedItemsInSection = deletedItems[@(section)];
+		if ([deletedItemsInSection containsIndex:item])
+			return nil;
+		item -= [deletedItemsInSection countOfIndexesInRange:NSMakeRange(0, item)];
+		
+		// Every inserted item at or before the item's position pushes it one further.
+		NSIndexSet *insertedItemsInSection = insertedItems[@(section)];
+		for (NSUInteger insertedItem = insertedItemsInSection.firstIndex; insertedItem != NSNotFound && insertedItem <= item; insertedItem = [insertedItemsInSection indexGreaterThanIndex:insertedItem]) {
+			item++;
+		}
+		
+		return [NSIndexPath jnw_indexPathForItem:(NSInteger)item inSection:section];
+	}];
+}
+
+- (NSDictionary *)itemsBySectionForIndexPaths:(NSArray *)indexPaths {
+	NSMutableDictionary *itemsBySection = [NSMutableDictionary dictionary];
+	for (NSIndexPath *indexPath in indexPaths) {
+		NSMutableIndexSet *items = itemsBySection[@(indexPath.jnw_section)];
+		if (items == nil) {
+			items = [NSMutableIndexSet indexSet];
+			itemsBySection[@(indexPath.jnw_section)] = items;
+		}
+		[items addIndex:(NSUInteger)indexPath.jnw_item];
+	}
+	return itemsBySection;
+}
+
+- (void)removeAllSnapshots {
+	[self.entries removeAllObjects];
+}
+
+@end
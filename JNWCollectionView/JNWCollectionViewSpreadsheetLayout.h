@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewLayout.h"
+
+/// The delegate is responsible for returning size information for the spreadsheet layout.
+@protocol JNWCollectionViewSpreadsheetLayoutDelegate <NSObject>
+
+@optional
+
+/// Asks the delegate for the height of the specified row.
+///
+/// If this method is not implemented, `rowHeight` is used for every row.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForRow:(NSInteger)row;
+
+/// Asks the delegate for the width of the specified column.
+///
+/// If this method is not implemented, `columnWidth` is used for every column.
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView widthForColumn:(NSInteger)column;
+
+@end
+
+/// A layout subclass that displays items in a table of rows and columns which scrolls
+/// in both directions.
+///
+/// Each section is a row, and each item in a section is a cell in the column with the
+/// same index. Rows and columns have independent heights and widths, so the layout only
+/// stores one offset per row and one per column, and only the items in the visible rows
+/// and columns are ever asked for.
+///
+/// Leading rows and columns can be frozen, so that they stay visible as headers while the
+/// rest of the table scrolls underneath them.
+@interface JNWCollectionViewSpreadsheetLayout : JNWCollectionViewLayout
+
+/// The delegate for the spreadsheet layout. The delegate, if needed, should be set before
+/// the collection view is reloaded.
+@property (nonatomic, unsafe_unretained) id<JNWCollectionViewSpreadsheetLayoutDelegate> delegate;
+
+/// The height of all rows, unless the delegate specifies otherwise.
+///
+/// Defaults to 22.
+@property (nonatomic, assign) CGFloat rowHeight;
+
+/// The width of all columns, unless the delegate specifies otherwise.
+///
+/// Defaults to 100.
+@property (nonatomic, assign) CGFloat columnWidth;
+
+/// The number of rows at the top which stay in place when scrolling vertically.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) NSInteger numberOfFrozenRows;
+
+/// The number of columns on the left which stay in place when scrolling horizontally.
+///
+/// Defaults to 0.
+@property (nonatomic, assign) NSInteger numberOfFrozenColumns;
+
+@end
@@ -0,0 +1,239 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewSpreadsheetLayout.h"
+
+/// Returns the range of the indexes whose extent, given by the sorted offsets array with one
+/// more entry than the number of extents, intersects the interval from min to max.
+static NSRange JNWSpreadsheetRangeBetweenOffsets(const CGFloat *offsets, NSInteger count, CGFloat min, CGFloat max) {
+	// The first extent ending below the minimum.
+	NSInteger low = 0;
+	NSInteger high = count;
+	while (low < high) {
+		NSInteger mid = (low + high) / 2;
+		if (offsets[mid + 1] > min) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	NSInteger first = low;
+	
+	// The first extent starting at or after the maximum.
+	high = count;
+	while (low < high) {
+		NSInteger mid = (low + high) / 2;
+		if (offsets[mid] < max) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	
+	return NSMakeRange(first, low - first);
+}
+
+@interface JNWCollectionViewSpreadsheetLayout()
+@property (nonatomic, assign) NSInteger numberOfRows;
+@property (nonatomic, assign) NSInteger numberOfColumns;
+@end
+
+@implementation JNWCollectionViewSpreadsheetLayout {
+	CGFloat *_rowOffsets;
+	CGFloat *_columnOffsets;
+}
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	self.rowHeight = 22.f;
+	self.columnWidth = 100.f;
+	return self;
+}
+
+- (void)dealloc {
+	free(_rowOffsets);
+	free(_columnOffsets);
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds {
+	// None of the geometry depends on the size of the collection view.
+	return NO;
+}
+
+- (JNWCollectionViewScrollDirection)scrollDirection {
+	return JNWCollectionViewScrollDirectionBoth;
+}
+
+- (void)prepareLayout {
+	if (self.delegate != nil && ![self.delegate conformsToProtocol:@protocol(JNWCollectionViewSpreadsheetLayoutDelegate)]) {
+		NSLog(@"*** spreadsheet delegate does not conform to JNWCollectionViewSpreadsheetLayoutDelegate!");
+	}
+	
+	BOOL delegateHeightForRow = [self.delegate respondsToSelector:@selector(collectionView:heightForRow:)];
+	BOOL delegateWidthForColumn = [self.delegate respondsToSelector:@selector(collectionView:widthForColumn:)];
+	JNWCollectionView *collectionView = self.collectionView;
+	
+	NSInteger numberOfRows = [collectionView numberOfSections];
+	NSInteger numberOfColumns = 0;
+	for (NSInteger row = 0; row < numberOfRows; row++) {
+		numberOfColumns = MAX(numberOfColumns, [collectionView numberOfItemsInSection:row]);
+	}
+	
+	self.numberOfRows = numberOfRows;
+	self.numberOfColumns = numberOfColumns;
+	
+	_rowOffsets = realloc(_rowOffsets, (numberOfRows + 1) * sizeof(CGFloat));
+	_columnOffsets = realloc(_columnOffsets, (numberOfColumns + 1) * sizeof(CGFloat));
+	
+	_rowOffsets[0] = 0;
+	for (NSInteger row = 0; row < numberOfRows; row++) {
+		CGFloat height = delegateHeightForRow ? [self.delegate collectionView:collectionView heightForRow:row] : self.rowHeight;
+		_rowOffsets[row + 1] = _rowOffsets[row] + height;
+	}
+	
+	_columnOffsets[0] = 0;
+	for (NSInteger column = 0; column < numberOfColumns; column++) {
+		CGFloat width = delegateWidthForColumn ? [self.delegate collectionView:collectionView widthForColumn:column] : self.columnWidth;
+		_columnOffsets[column + 1] = _columnOffsets[column] + width;
+	}
+}
+
+- (CGSize)contentSize {
+	if (_rowOffsets == NULL || _columnOffsets == NULL)
+		return CGSizeZero;
+	
+	return CGSizeMake(_columnOffsets[self.numberOfColumns], _rowOffsets[self.numberOfRows]);
+}
+
+- (CGRect)rectForSectionAtIndex:(NSInteger)index {
+	return CGRectMake(0, _rowOffsets[index], _columnOffsets[self.numberOfColumns], _rowOffsets[index + 1] - _rowOffsets[index]);
+}
+
+/// The distance the frozen rows and columns are shifted by to keep them in view.
+- (CGPoint)frozenOffset {
+	CGPoint origin = self.collectionView.documentVisibleRect.origin;
+	return CGPointMake(MAX(0, origin.x), MAX(0, origin.y));
+}
+
+- (NSInteger)frozenRowCount {
+	return MIN(MAX(self.numberOfFrozenRows, 0), self.numberOfRows);
+}
+
+- (NSInteger)frozenColumnCount {
+	return MIN(MAX(self.numberOfFrozenColumns, 0), self.numberOfColumns);
+}
+
+- (JNWCollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath {
+	NSInteger row = indexPath.jnw_section;
+	NSInteger column = indexPath.jnw_item;
+	BOOL frozenRow = row < self.frozenRowCount;
+	BOOL frozenColumn = column < self.frozenColumnCount;
+	
+	CGRect frame = CGRectMake(_columnOffsets[column], _rowOffsets[row], _columnOffsets[column + 1] - _columnOffsets[column], _rowOffsets[row + 1] - _rowOffsets[row]);
+	if (frozenRow || frozenColumn) {
+		CGPoint frozenOffset = self.frozenOffset;
+		if (frozenRow)
+			frame.origin.y += frozenOffset.y;
+		if (frozenColumn)
+			frame.origin.x += frozenOffset.x;
+	}
+	
+	JNWCollectionViewLayoutAttributes *attributes = [[JNWCollectionViewLayoutAttributes alloc] init];
+	attributes.frame = frame;
+	attributes.alpha = 1.f;
+	// Frozen items cover the items scrolling underneath them, and the corner covers both.
+	attributes.zIndex = (frozenRow ? 1 : 0) + (frozenColumn ? 1 : 0);
+	return attributes;
+}
+
+- (NSArray *)indexPathsForItemsInRect:(CGRect)rect {
+	NSMutableArray *indexPaths = [NSMutableArray array];
+	if (self.numberOfRows == 0 || self.numberOfColumns == 0)
+		return indexPaths;
+	
+	CGPoint frozenOffset = self.frozenOffset;
+	NSInteger frozenRowCount = self.frozenRowCount;
+	NSInteger frozenColumnCount = self.frozenColumnCount;
+	
+	// The frozen and scrolling parts of each axis are searched separately, as the frozen part is
+	// shifted by the scroll offset. Only the intersection of the resulting row and column ranges
+	// is enumerated.
+	NSRange frozenRows = NSIntersectionRange(JNWSpreadsheetRangeBetweenOffsets(_rowOffsets, self.numberOfRows, CGRectGetMinY(rect) - frozenOffset.y, CGRectGetMaxY(rect) - frozenOffset.y), NSMakeRange(0, frozenRowCount));
+	NSRange scrollingRows = NSIntersectionRange(JNWSpreadsheetRangeBetweenOffsets(_rowOffsets, self.numberOfRows, CGRectGetMinY(rect), CGRectGetMaxY(rect)), NSMakeRange(frozenRowCount, self.numberOfRows - frozenRowCount));
+	NSRange frozenColumns = NSIntersectionRange(JNWSpreadsheetRangeBetweenOffsets(_columnOffsets, self.numberOfColumns, CGRectGetMinX(rect) - frozenOffset.x, CGRectGetMaxX(rect) - frozenOffset.x), NSMakeRange(0, frozenColumnCount));
+	NSRange scrollingColumns = NSIntersectionRange(JNWSpreadsheetRangeBetweenOffsets(_columnOffsets, self.numberOfColumns, CGRectGetMinX(rect), CGRectGetMaxX(rect)), NSMakeRange(frozenColumnCount, self.numberOfColumns - frozenColumnCount));
+	
+	// Frozen items are listed first, since they are on top when hit-testing.
+	NSRange rowRanges[] = { frozenRows, frozenRows, scrollingRows, scrollingRows };
+	NSRange columnRanges[] = { frozenColumns, scrollingColumns, frozenColumns, scrollingColumns };
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	for (NSInteger rangeIdx = 0; rangeIdx < 4; rangeIdx++) {
+		NSRange rows = rowRanges[rangeIdx];
+		NSRange columns = columnRanges[rangeIdx];
+		
+		for (NSUInteger row = rows.location; row < NSMaxRange(rows); row++) {
+			NSUInteger lastColumn = MIN(NSMaxRange(columns), (NSUInteger)[collectionView numberOfItemsInSection:row]);
+			for (NSUInteger column = columns.location; column < lastColumn; column++) {
+				[indexPaths addObject:[NSIndexPath jnw_indexPathForItem:column inSection:row]];
+			}
+		}
+	}
+	
+	return indexPaths;
+}
+
+- (NSDictionary *)indexesForSupplementaryItemsOfKinds:(NSArray *)kinds inRect:(CGRect)rect {
+	// Headers are frozen rows and columns, rather than supplementary views.
+	return @{};
+}
+
+- (BOOL)shouldApplyExistingLayoutAttributesOnLayout {
+	// The frozen items move on every scroll. The other items are skipped cheaply by the
+	// collection view, since their attributes don't change.
+	return (self.frozenRowCount > 0 || self.frozenColumnCount > 0);
+}
+
+- (NSIndexPath *)indexPathForNextItemInDirection:(JNWCollectionViewDirection)direction currentIndexPath:(NSIndexPath *)currentIndexPath {
+	NSInteger row = currentIndexPath.jnw_section;
+	NSInteger column = currentIndexPath.jnw_item;
+	
+	switch (direction) {
+		case JNWCollectionViewDirectionUp:
+			row--;
+			break;
+		case JNWCollectionViewDirectionDown:
+			row++;
+			break;
+		case JNWCollectionViewDirectionLeft:
+			column--;
+			break;
+		case JNWCollectionViewDirectionRight:
+			column++;
+			break;
+	}
+	
+	if (row < 0 || row >= self.numberOfRows || column < 0 || column >= [self.collectionView numberOfItemsInSection:row])
+		return currentIndexPath;
+	
+	return [NSIndexPath jnw_indexPathForItem:column inSection:row];
+}
+
+@end
@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import <Cocoa/Cocoa.h>
+
+@class JNWCollectionViewCell;
+
+typedef void (^JNWThumbnailCompletionHandler)(NSImage *thumbnail);
+
+/// Loads downsampled thumbnails of image files in the background and keeps the decoded
+/// results in memory, evicting the least recently used thumbnails once the total cost
+/// exceeds `totalCostLimit`.
+///
+/// Images are decoded and scaled down to the requested size with ImageIO on a background
+/// queue, so the full-size image is never decoded on the main thread or kept in memory.
+/// Multiple requests for the same thumbnail while it is being decoded share a single decode.
+///
+/// All methods must be called from the main thread, and completion handlers are always
+/// called on the main thread.
+@interface JNWCollectionViewThumbnailCache : NSObject
+
+/// A shared cache with the default cost limit.
++ (instancetype)sharedCache;
+
+/// The maximum total cost, in bytes of decoded pixel data, of the thumbnails held by the
+/// cache. Lowering the limit immediately evicts thumbnails until the cache fits.
+///
+/// Defaults to 64MB.
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/// The total cost of the thumbnails currently held by the cache.
+@property (nonatomic, assign, readonly) NSUInteger totalCost;
+
+/// The maximum number of images decoded at the same time.
+///
+/// Defaults to the number of active processors.
+@property (nonatomic, assign) NSInteger maxConcurrentDecodes;
+
+/// Returns the cached thumbnail for the file at the URL, or nil if it hasn't been loaded.
+///
+/// The size is in points. The thumbnail is sized to fit within the size at the given scale.
+- (NSImage *)cachedThumbnailForURL:(NSURL *)URL size:(CGSize)size scale:(CGFloat)scale;
+
+/// Loads the thumbnail for the file at the URL, calling the handler once it is available.
+///
+/// If the thumbnail is cached, the handler is called immediately and nil is returned.
+/// Otherwise a token is returned which can be passed to -cancelThumbnailRequest: if the
+/// thumbnail is no longer needed. The handler is called with nil if the image could not
+/// be decoded, and is never called for a cancelled request.
+- (id)loadThumbnailForURL:(NSURL *)URL size:(CGSize)size scale:(CGFloat)scale completionHandler:(JNWThumbnailCompletionHandler)completionHandler;
+
+/// Cancels the request with the token returned from -loadThumbnailForURL:size:scale:completionHandler:.
+///
+/// The decode itself is only cancelled once no other requests are waiting for it.
+- (void)cancelThumbnailRequest:(id)token;
+
+/// Loads a thumbnail for display in the cell, using the backing scale factor of the
+/// cell's window.
+///
+/// Only one request is tracked per cell, so starting a new request for the cell cancels
+/// the previous one. This makes it safe to call from -collectionView:cellForItemAtIndexPath:
+/// without the thumbnail for a previous item landing in a reused cell.
+- (void)loadThumbnailForURL:(NSURL *)URL size:(CGSize)size cell:(JNWCollectionViewCell *)cell completionHandler:(JNWThumbnailCompletionHandler)completionHandler;
+
+/// Cancels any request started for the cell.
+///
+/// This should be called from -collectionView:didEndDisplayingCell:forItemAtIndexPath: so
+/// that items which have been scrolled past are not decoded.
+- (void)cancelThumbnailRequestForCell:(JNWCollectionViewCell *)cell;
+
+/// Removes all cached thumbnails. Requests in flight are not affected.
+- (void)removeAllThumbnails;
+
+#pragma mark Statistics
+
+/// The number of requests that were served from the cache.
+@property (nonatomic, assign, readonly) NSUInteger numberOfHits;
+
+/// The number of requests that were not in the cache, including those joining a decode
+/// already in flight.
+@property (nonatomic, assign, readonly) NSUInteger numberOfMisses;
+
+/// The number of decodes whose thumbnail was stored or delivered to a request. Decodes that were
+/// cancelled or superseded by a newer decode of the same thumbnail aren't counted.
+@property (nonatomic, assign, readonly) NSUInteger numberOfDecodes;
+
+/// Resets the statistics counters to zero.
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,297 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewThumbnailCache.h"
+#import "JNWCollectionViewCell.h"
+#import "JNWCollectionViewLRUCache.h"
+#import <ImageIO/ImageIO.h>
+
+static const NSUInteger JNWThumbnailCacheDefaultCostLimit = 64 * 1024 * 1024;
+
+// A decode in flight, shared by every request for the same thumbnail.
+@interface JNWThumbnailDecode : NSObject
+@property (nonatomic, strong) NSOperation *operation;
+@property (nonatomic, strong) NSMutableArray *requests;
+@end
+
+@implementation JNWThumbnailDecode
+@end
+
+// The token handed out for each request that has to wait for a decode.
+@interface JNWThumbnailRequest : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) JNWThumbnailCompletionHandler completionHandler;
+@end
+
+@implementation JNWThumbnailRequest
+@end
+
+@interface JNWCollectionViewThumbnailCache()
+@property (nonatomic, strong) JNWCollectionViewLRUCache *thumbnails; // { key : image }
+@property (nonatomic, strong) NSMutableDictionary *decodes;
+@property (nonatomic, strong) NSMapTable *cellRequests;
+@property (nonatomic, strong) NSOperationQueue *decodeQueue;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfHits;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfMisses;
+@property (nonatomic, assign, readwrite) NSUInteger numberOfDecodes;
+@end
+
+@implementation JNWCollectionViewThumbnailCache
+
++ (instancetype)sharedCache {
+	static JNWCollectionViewThumbnailCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[JNWCollectionViewThumbnailCache alloc] init];
+	});
+	return sharedCache;
+}
+
+- (instancetype)init {
+	self = [super init];
+	if (self == nil) return nil;
+	
+	_thumbnails = [[JNWCollectionViewLRUCache alloc] init];
+	_thumbnails.totalCostLimit = JNWThumbnailCacheDefaultCostLimit;
+	_decodes = [NSMutableDictionary dictionary];
+	_cellRequests = [NSMapTable weakToStrongObjectsMapTable];
+	
+	_decodeQueue = [[NSOperationQueue alloc] init];
+	_decodeQueue.name = @"com.jwilling.JNWCollectionView.thumbnails";
+	_decodeQueue.maxConcurrentOperationCount = [NSProcessInfo processInfo].activeProcessorCount;
+	
+	return self;
+}
+
+- (void)dealloc {
+	[_decodeQueue cancelAllOperations];
+}
+
+- (NSUInteger)totalCostLimit {
+	return self.thumbnails.totalCostLimit;
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+	self.thumbnails.totalCostLimit = totalCostLimit;
+}
+
+- (NSUInteger)totalCost {
+	return self.thumbnails.totalCost;
+}
+
+- (NSInteger)maxConcurrentDecodes {
+	return self.decodeQueue.maxConcurrentOperationCount;
+}
+
+- (void)setMaxConcurrentDecodes:(NSInteger)maxConcurrentDecodes {
+	self.decodeQueue.maxConcurrentOperationCount = maxConcurrentDecodes;
+}
+
+#pragma mark Loading
+
+static NSString *JNWThumbnailKey(NSURL *URL, CGSize size, CGFloat scale) {
+	return [NSString stringWithFormat:@"%@|%@@%g", URL.absoluteString, NSStringFromSize(size), scale];
+}
+
+- (NSImage *)cachedThumbnailForURL:(NSURL *)URL size:(CGSize)size scale:(CGFloat)scale {
+	return [self.thumbnails objectForKey:JNWThumbnailKey(URL, size, scale)];
+}
+
+- (id)loadThumbnailForURL:(NSURL *)URL size:(CGSize)size scale:(CGFloat)scale completionHandler:(JNWThumbnailCompletionHandler)completionHandler {
+	NSParameterAssert(URL != nil);
+	NSParameterAssert(completionHandler != nil);
+	
+	NSString *key = JNWThumbnailKey(URL, size, scale);
+	NSImage *thumbnail = [self.thumbnails objectForKey:key];
+	if (thumbnail != nil) {
+		self.numberOfHits++;
+		completionHandler(thumbnail);
+		return nil;
+	}
+	
+	self.numberOfMisses++;
+	
+	JNWThumbnailRequest *request = [[JNWThumbnailRequest alloc] init];
+	request.key = key;
+	request.completionHandler = completionHandler;
+	
+	JNWThumbnailDecode *decode = self.decodes[key];
+	if (decode == nil) {
+		decode = [[JNWThumbnailDecode alloc] init];
+		decode.requests = [NSMutableArray array];
+		decode.operation = [self decodeOperationForURL:URL size:size scale:scale key:key];
+		self.decodes[key] = decode;
+		[self.decodeQueue addOperation:decode.operation];
+	}
+	
+	[decode.requests addObject:request];
+	return request;
+}
+
+- (void)cancelThumbnailRequest:(id)token {
+	if (token == nil)
+		return;
+	
+	JNWThumbnailRequest *request = token;
+	JNWThumbnailDecode *decode = self.decodes[request.key];
+	if (decode == nil)
+		return;
+	
+	[decode.requests removeObjectIdenticalTo:request];
+	
+	// Nobody is waiting for this thumbnail any longer, so don't spend time decoding it.
+	if (decode.requests.count == 0) {
+		[decode.operation cancel];
+		[self.decodes removeObjectForKey:request.key];
+	}
+}
+
+- (NSOperation *)decodeOperationForURL:(NSURL *)URL size:(CGSize)size scale:(CGFloat)scale key:(NSString *)key {
+	NSBlockOperation *operation = [[NSBlockOperation alloc] init];
+	__weak NSBlockOperation *weakOperation = operation;
+	__weak typeof(self) weakSelf = self;
+	
+	[operation addExecutionBlock:^{
+		if (weakOperation.isCancelled)
+			return;
+		
+		CGImageRef thumbnail = JNWCreateThumbnail(URL, size, scale);
+		NSImage *image = nil;
+		NSUInteger cost = 0;
+		if (thumbnail != NULL) {
+			CGSize pixelSize = CGSizeMake(CGImageGetWidth(thumbnail), CGImageGetHeight(thumbnail));
+			image = [[NSImage alloc] initWithCGImage:thumbnail size:NSMakeSize(pixelSize.width / scale, pixelSize.height / scale)];
+			cost = CGImageGetBytesPerRow(thumbnail) * CGImageGetHeight(thumbnail);
+			CGImageRelease(thumbnail);
+		}
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[weakSelf finishDecodeOperation:weakOperation key:key image:image cost:cost];
+		});
+	}];
+	
+	return operation;
+}
+
+- (void)finishDecodeOperation:(NSOperation *)operation key:(NSString *)key image:(NSImage *)image cost:(NSUInteger)cost {
+	JNWThumbnailDecode *decode = self.decodes[key];
+	
+	// The decode was cancelled after it had started, and possibly restarted since.
+	if (decode == nil || decode.operation != operation) {
+		return;
+	}
+	
+	self.numberOfDecodes++;
+	[self.decodes removeObjectForKey:key];
+	
+	if (image != nil) {
+		[self.thumbnails setObject:image forKey:key cost:cost];
+	}
+	
+	for (JNWThumbnailRequest *request in decode.requests) {
+		request.completionHandler(image);
+	}
+}
+
+// Decodes the image at the URL directly at the size needed to fit within the given size.
+// The thumbnail is decoded immediately so that drawing it on the main thread is cheap.
+static CGImageRef JNWCreateThumbnail(NSURL *URL, CGSize size, CGFloat scale) {
+	CGImageSourceRef source = CGImageSourceCreateWithURL((__bridge CFURLRef)URL, (__bridge CFDictionaryRef)@{ (__bridge NSString *)kCGImageSourceShouldCache: @NO });
+	if (source == NULL)
+		return NULL;
+	
+	CGFloat maxPixelSize = MAX(size.width, size.height) * scale;
+	
+	// Reading the properties only parses the header. The pixel size is needed so that
+	// an image with a different aspect ratio than the target still fits within it.
+	NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+	CGFloat pixelWidth = [properties[(__bridge NSString *)kCGImagePropertyPixelWidth] doubleValue];
+	CGFloat pixelHeight = [properties[(__bridge NSString *)kCGImagePropertyPixelHeight] doubleValue];
+	if ([properties[(__bridge NSString *)kCGImagePropertyOrientation] integerValue] >= 5) {
+		CGFloat width = pixelWidth;
+		pixelWidth = pixelHeight;
+		pixelHeight = width;
+	}
+	
+	if (pixelWidth > 0 && pixelHeight > 0) {
+		CGFloat factor = MIN(1, MIN(size.width * scale / pixelWidth, size.height * scale / pixelHeight));
+		maxPixelSize = MAX(pixelWidth, pixelHeight) * factor;
+	}
+	
+	NSDictionary *options = @{ (__bridge NSString *)kCGImageSourceCreateThumbnailFromImageAlways: @YES,
+							   (__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform: @YES,
+							   (__bridge NSString *)kCGImageSourceShouldCacheImmediately: @YES,
+							   (__bridge NSString *)kCGImageSourceThumbnailMaxPixelSize: @(MAX(1, ceil(maxPixelSize))) };
+	CGImageRef thumbnail = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+	CFRelease(source);
+	
+	return thumbnail;
+}
+
+#pragma mark Cells
+
+- (void)loadThumbnailForURL:(NSURL *)URL size:(CGSize)size cell:(JNWCollectionViewCell *)cell completionHandler:(JNWThumbnailCompletionHandler)completionHandler {
+	NSParameterAssert(cell != nil);
+	
+	[self cancelThumbnailRequestForCell:cell];
+	
+	CGFloat scale = cell.window.backingScaleFactor ?: [NSScreen mainScreen].backingScaleFactor ?: 1;
+	
+	__weak typeof(self) weakSelf = self;
+	__weak JNWCollectionViewCell *weakCell = cell;
+	__weak __block id weakToken = nil;
+	id token = [self loadThumbnailForURL:URL size:size scale:scale completionHandler:^(NSImage *thumbnail) {
+		JNWCollectionViewCell *strongCell = weakCell;
+		if (weakToken != nil && strongCell != nil && [weakSelf.cellRequests objectForKey:strongCell] == weakToken) {
+			[weakSelf.cellRequests removeObjectForKey:strongCell];
+		}
+		completionHandler(thumbnail);
+	}];
+	
+	// The request holds on to the completion handler, so it is only referenced weakly from there.
+	if (token != nil) {
+		weakToken = token;
+		[self.cellRequests setObject:token forKey:cell];
+	}
+}
+
+- (void)cancelThumbnailRequestForCell:(JNWCollectionViewCell *)cell {
+	id token = [self.cellRequests objectForKey:cell];
+	if (token == nil)
+		return;
+	
+	[self cancelThumbnailRequest:token];
+	[self.cellRequests removeObjectForKey:cell];
+}
+
+#pragma mark Cache
+
+- (void)removeAllThumbnails {
+	[self.thumbnails removeAllObjects];
+}
+
+#pragma mark Statistics
+
+- (void)resetStatistics {
+	self.numberOfHits = 0;
+	self.numberOfMisses = 0;
+	self.numberOfDecodes = 0;
+}
+
+@end
@@ -0,0 +1,52 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class JNWCollectionView;
+
+/// A sorted index of the type-select strings of all items in a collection view, used to find the
+/// first item whose string begins with a prefix in logarithmic time.
+///
+/// Strings are compared case and diacritic insensitively. The index is built on a background queue
+/// the first time it is needed, and patched as items are inserted and deleted.
+@interface JNWCollectionViewTypeSelectIndex : NSObject
+
+- (instancetype)initWithCollectionView:(JNWCollectionView *)collectionView;
+
+/// Whether the index has been built and can be searched.
+@property (nonatomic, assign, readonly, getter=isBuilt) BOOL built;
+
+/// Starts building the index if it isn't built or being built. The completion handler is called
+/// on the main thread once the index has been built, unless it is invalidated in the meantime.
+- (void)buildWithCompletionHandler:(void (^)(void))completionHandler;
+
+/// Returns the first item in sort order whose string begins with the prefix, ignoring case and
+/// diacritics. Returns nil if no string does, or if the index isn't built.
+- (NSIndexPath *)indexPathForPrefix:(NSString *)prefix;
+
+/// Discards the index, for example when the data is reloaded.
+- (void)invalidate;
+
+/// Updates the index for items which have been inserted or deleted. The data source must already
+/// reflect the change.
+- (void)insertItemsAtIndexPaths:(NSArray *)indexPaths;
+- (void)deleteItemsAtIndexPaths:(NSArray *)indexPaths;
+
+@end
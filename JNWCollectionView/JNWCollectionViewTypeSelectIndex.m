@@ -0,0 +1,256 @@
+/*
+ Copyright (c) 2013, Jonathan Willing. All rights reserved.
+ Licensed under the MIT license <http://opensource.org/licenses/MIT>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ IN THE SOFTWARE.
+ */
+
+#import "JNWCollectionViewTypeSelectIndex.h"
+#import "JNWCollectionViewFramework.h"
+
+@interface JNWCollectionViewTypeSelectEntry : NSObject {
+@public
+	NSString *_string;
+	NSInteger _section;
+	NSInteger _item;
+}
+@end
+
+@implementation JNWCollectionViewTypeSelectEntry
+@end
+
+static NSString *JNWCollectionViewTypeSelectFoldedString(NSString *string) {
+	return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil] ?: @"";
+}
+
+// Entries are ordered by string, and then by index path so that the first item wins among equal strings.
+static NSInteger JNWCollectionViewTypeSelectCompareEntries(id object1, id object2, void *context) {
+	JNWCollectionViewTypeSelectEntry *entry1 = object1;
+	JNWCollectionViewTypeSelectEntry *entry2 = object2;
+	NSComparisonResult result = [entry1->_string compare:entry2->_string options:NSLiteralSearch];
+	if (result != NSOrderedSame)
+		return result;
+	if (entry1->_section != entry2->_section)
+		return (entry1->_section < entry2->_section ? NSOrderedAscending : NSOrderedDescending);
+	if (entry1->_item != entry2->_item)
+		return (entry1->_item < entry2->_item ? NSOrderedAscending : NSOrderedDescending);
+	return NSOrderedSame;
+}
+
+@interface JNWCollectionViewTypeSelectIndex()
+@property (nonatomic, weak) JNWCollectionView *collectionView;
+@property (nonatomic, strong) NSMutableArray *entries; // nil until built
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, assign) BOOL building;
+@property (nonatomic, strong) NSMutableArray *completionHandlers;
+@end
+
+@implementation JNWCollectionViewTypeSelectIndex
+
+- (instancetype)initWithCollectionView:(JNWCollectionView *)collectionView {
+	self = [super init];
+	if (self == nil) return nil;
+	_collectionView = collectionView;
+	_completionHandlers = [NSMutableArray array];
+	return self;
+}
+
+- (BOOL)isBuilt {
+	return (self.entries != nil);
+}
+
+- (void)invalidate {
+	self.generation++;
+	self.entries = nil;
+	self.building = NO;
+	[self.completionHandlers removeAllObjects];
+}
+
+#pragma mark Building
+
+- (void)buildWithCompletionHandler:(void (^)(void))completionHandler {
+	if (self.built) {
+		if (completionHandler != nil) completionHandler();
+		return;
+	}
+	
+	if (completionHandler != nil) {
+		[self.completionHandlers addObject:[completionHandler copy]];
+	}
+	
+	if (self.building)
+		return;
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	id<JNWCollectionViewDataSource> dataSource = collectionView.dataSource;
+	if (![dataSource respondsToSelector:@selector(collectionView:typeSelectStringForItemAtIndexPath:)])
+		return;
+	
+	// The number of items is read on the main thread, and only the strings are requested in the background.
+	NSInteger numberOfSections = collectionView.numberOfSections;
+	NSMutableData *numberOfItemsData = [NSMutableData dataWithLength:numberOfSections * sizeof(NSInteger)];
+	NSInteger *numberOfItems = numberOfItemsData.mutableBytes;
+	for (NSInteger section = 0; section < numberOfSections; section++) {
+		numberOfItems[section] = [collectionView numberOfItemsInSection:section];
+	}
+	
+	self.building = YES;
+	NSUInteger generation = self.generation;
+	__weak typeof(self) weakSelf = self;
+	
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		const NSInteger *itemCounts = numberOfItemsData.bytes;
+		NSMutableArray *entries = [NSMutableArray array];
+		
+		for (NSInteger section = 0; section < numberOfSections; section++) {
+			for (NSInteger item = 0; item < itemCounts[section]; item++) {
+				@autoreleasepool {
+					NSIndexPath *indexPath = [NSIndexPath jnw_indexPathForItem:item inSection:section];
+					JNWCollectionViewTypeSelectEntry *entry = [[JNWCollectionViewTypeSelectEntry alloc] init];
+					entry->_string = JNWCollectionViewTypeSelectFoldedString([dataSource collectionView:collectionView typeSelectStringForItemAtIndexPath:indexPath]);
+					entry->_section = section;
+					entry->_item = item;
+					[entries addObject:entry];
+				}
+			}
+		}
+		
+		[entries sortUsingFunction:JNWCollectionViewTypeSelectCompareEntries context:NULL];
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			typeof(self) strongSelf = weakSelf;
+			if (strongSelf == nil || strongSelf.generation != generation)
+				return;
+			
+			strongSelf.entries = entries;
+			strongSelf.building = NO;
+			
+			NSArray *completionHandlers = [strongSelf.completionHandlers copy];
+			[strongSelf.completionHandlers removeAllObjects];
+			for (void (^handler)(void) in completionHandlers) {
+				handler();
+			}
+		});
+	});
+}
+
+#pragma mark Searching
+
+/// Returns the index of the first entry that isn't ordered before the entry.
+- (NSUInteger)insertionIndexForEntry:(JNWCollectionViewTypeSelectEntry *)entry {
+	NSUInteger low = 0;
+	NSUInteger high = self.entries.count;
+	while (low < high) {
+		NSUInteger mid = low + (high - low) / 2;
+		if (JNWCollectionViewTypeSelectCompareEntries(self.entries[mid], entry, NULL) == NSOrderedAscending) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+- (NSIndexPath *)indexPathForPrefix:(NSString *)prefix {
+	if (self.entries.count == 0)
+		return nil;
+	
+	// Searching for the prefix itself finds the first string that begins with it, if there is one.
+	JNWCollectionViewTypeSelectEntry *key = [[JNWCollectionViewTypeSelectEntry alloc] init];
+	key->_string = JNWCollectionViewTypeSelectFoldedString(prefix);
+	key->_section = NSIntegerMin;
+	key->_item = NSIntegerMin;
+	
+	NSUInteger index = [self insertionIndexForEntry:key];
+	if (index >= self.entries.count)
+		return nil;
+	
+	JNWCollectionViewTypeSelectEntry *entry = self.entries[index];
+	if (![entry->_string hasPrefix:key->_string])
+		return nil;
+	
+	return [NSIndexPath jnw_indexPathForItem:entry->_item inSection:entry->_section];
+}
+
+#pragma mark Updating
+
+- (void)insertItemsAtIndexPaths:(NSArray *)indexPaths {
+	if (!self.built) {
+		// A build in progress has read the old number of items, so it has to start over.
+		if (self.building) {
+			[self invalidate];
+		}
+		return;
+	}
+	
+	NSArray *insertedIndexPaths = [indexPaths sortedArrayUsingSelector:@selector(compare:)];
+	
+	// Shift the existing items past the inserted ones. Both are in ascending order, so an item only has to
+	// be compared with insertions until it is past one.
+	for (JNWCollectionViewTypeSelectEntry *entry in self.entries) {
+		for (NSIndexPath *indexPath in insertedIndexPaths) {
+			if (indexPath.jnw_section != entry->_section)
+				continue;
+			if (indexPath.jnw_item > entry->_item)
+				break;
+			entry->_item++;
+		}
+	}
+	
+	JNWCollectionView *collectionView = self.collectionView;
+	id<JNWCollectionViewDataSource> dataSource = collectionView.dataSource;
+	for (NSIndexPath *indexPath in insertedIndexPaths) {
+		JNWCollectionViewTypeSelectEntry *entry = [[JNWCollectionViewTypeSelectEntry alloc] init];
+		entry->_string = JNWCollectionViewTypeSelectFoldedString([dataSource collectionView:collectionView typeSelectStringForItemAtIndexPath:indexPath]);
+		entry->_section = indexPath.jnw_section;
+		entry->_item = indexPath.jnw_item;
+		[self.entries insertObject:entry atIndex:[self insertionIndexForEntry:entry]];
+	}
+}
+
+- (void)deleteItemsAtIndexPaths:(NSArray *)indexPaths {
+	if (!self.built) {
+		if (self.building) {
+			[self invalidate];
+		}
+		return;
+	}
+	
+	NSArray *deletedIndexPaths = [indexPaths sortedArrayUsingSelector:@selector(compare:)];
+	NSSet *deletedSet = [NSSet setWithArray:deletedIndexPaths];
+	
+	NSMutableIndexSet *removedEntries = [NSMutableIndexSet indexSet];
+	[self.entries enumerateObjectsUsingBlock:^(JNWCollectionViewTypeSelectEntry *entry, NSUInteger idx, BOOL *stop) {
+		if ([deletedSet containsObject:[NSIndexPath jnw_indexPathForItem:entry->_item inSection:entry->_section]]) {
+			[removedEntries addIndex:idx];
+			return;
+		}
+		
+		// Shift the remaining items back by the number of deleted items before them.
+		NSInteger shift = 0;
+		for (NSIndexPath *indexPath in deletedIndexPaths) {
+			if (indexPath.jnw_section != entry->_section)
+				continue;
+			if (indexPath.jnw_item > entry->_item)
+				break;
+			shift++;
+		}
+		entry->_item -= shift;
+	}];
+	
+	[self.entries removeObjectsAtIndexes:removedEntries];
+}
+
+@end
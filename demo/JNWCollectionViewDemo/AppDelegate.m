@@ -8,6 +8,7 @@
 
 #import "AppDelegate.h"
 #import "DemoWindowController.h"
+#import "DemoBenchmark.h"
 
 @interface AppDelegate()
 @property (nonatomic, strong) DemoWindowController *windowController;
@@ -16,8 +17,20 @@
 @implementation AppDelegate
 
 - (void)awakeFromNib {
+	if ([DemoBenchmark shouldRunBenchmarks]) {
+		// Run once the app has finished launching, outside of any main queue block, so that the benchmarks
+		// can spin the run loop to receive the results delivered to the main queue.
+		[self performSelector:@selector(runBenchmarks) withObject:nil afterDelay:0];
+		return;
+	}
+	
 	self.windowController = [[DemoWindowController alloc] init];
 	[self.windowController showWindow:nil];
 }
 
+- (void)runBenchmarks {
+	[[[DemoBenchmark alloc] init] run];
+	[NSApp terminate:nil];
+}
+
 @end
@@ -0,0 +1,22 @@
+//
+//  DemoBenchmark.h
+//  JNWCollectionViewDemo
+//
+
+#import <Foundation/Foundation.h>
+
+// Measures the thumbnail cache while scrolling and the preparation of large layouts, and logs the results.
+//
+// The benchmarks are run instead of showing the demo window when the app is launched
+// with the RunBenchmarks default set, for example from Terminal:
+//
+//   JNWCollectionViewDemo.app/Contents/MacOS/JNWCollectionViewDemo -RunBenchmarks YES
+//
+// Build the app in the Release configuration, as the numbers are meaningless otherwise.
+@interface DemoBenchmark : NSObject
+
++ (BOOL)shouldRunBenchmarks;
+
+- (void)run;
+
+@end
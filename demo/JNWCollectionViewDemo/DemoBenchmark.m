@@ -0,0 +1,220 @@
+//
+//  DemoBenchmark.m
+//  JNWCollectionViewDemo
+//
+
+#import "DemoBenchmark.h"
+#import <JNWCollectionView/JNWCollectionView.h>
+#import <QuartzCore/QuartzCore.h>
+
+// The thumbnail benchmark sweeps a window of visible items over a directory of generated photos,
+// the way a grid scrolled back and forth would request and cancel thumbnails.
+static const NSUInteger DemoBenchmarkNumberOfImages = 400;
+static const NSUInteger DemoBenchmarkNumberOfVisibleItems = 30;
+static const NSUInteger DemoBenchmarkNumberOfSweeps = 4;
+static const CGSize DemoBenchmarkImageSize = { 1600, 1200 };
+static const CGSize DemoBenchmarkThumbnailSize = { 160, 120 };
+
+// The layout benchmark prepares a million items spread over a thousand sections.
+static const NSInteger DemoBenchmarkNumberOfSections = 1000;
+static const NSUInteger DemoBenchmarkNumberOfItemsPerSection = 1000;
+static const NSUInteger DemoBenchmarkNumberOfLayoutRuns = 5;
+
+// A data source and list delegate with variable row heights, which the list layout asks for on the main thread.
+@interface DemoBenchmarkLayoutDataSource : NSObject <JNWCollectionViewDataSource, JNWCollectionViewListLayoutDelegate, JNWCollectionViewGridLayoutDelegate>
+@end
+
+@implementation DemoBenchmarkLayoutDataSource
+
+- (NSInteger)numberOfSectionsInCollectionView:(JNWCollectionView *)collectionView {
+	return DemoBenchmarkNumberOfSections;
+}
+
+- (NSUInteger)collectionView:(JNWCollectionView *)collectionView numberOfItemsInSection:(NSInteger)section {
+	return DemoBenchmarkNumberOfItemsPerSection;
+}
+
+- (JNWCollectionViewCell *)collectionView:(JNWCollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath {
+	return [[JNWCollectionViewCell alloc] initWithFrame:NSZeroRect];
+}
+
+- (CGFloat)collectionView:(JNWCollectionView *)collectionView heightForRowAtIndexPath:(NSIndexPath *)indexPath {
+	return 20 + (indexPath.jnw_item * 7 + indexPath.jnw_section) % 40;
+}
+
+@end
+
+// The same delegate, declaring that its row heights can be asked for from any thread.
+@interface DemoBenchmarkConcurrentLayoutDataSource : DemoBenchmarkLayoutDataSource <JNWCollectionViewListLayoutConcurrentDelegate>
+@end
+
+@implementation DemoBenchmarkConcurrentLayoutDataSource
+@end
+
+@implementation DemoBenchmark
+
++ (BOOL)shouldRunBenchmarks {
+	return [[NSUserDefaults standardUserDefaults] boolForKey:@"RunBenchmarks"];
+}
+
+- (void)run {
+	[self runThumbnailCacheBenchmark];
+	[self runLayoutPreparationBenchmark];
+}
+
+#pragma mark Layout Preparation
+
+// The parallel preparation uses as many threads as GCD gives it, which follows the number of active
+// processors. Comparing core counts means running this on machines with different numbers of cores.
+- (void)runLayoutPreparationBenchmark {
+	NSLog(@"Preparing %lu items in %ld sections on %lu active processors",
+		  (unsigned long)(DemoBenchmarkNumberOfSections * DemoBenchmarkNumberOfItemsPerSection), (long)DemoBenchmarkNumberOfSections,
+		  (unsigned long)[[NSProcessInfo processInfo] activeProcessorCount]);
+	
+	DemoBenchmarkLayoutDataSource *serialDataSource = [[DemoBenchmarkLayoutDataSource alloc] init];
+	JNWCollectionViewListLayout *serialListLayout = [[JNWCollectionViewListLayout alloc] init];
+	serialListLayout.delegate = serialDataSource;
+	CFTimeInterval serialDuration = [self durationOfPreparingLayout:serialListLayout dataSource:serialDataSource];
+	NSLog(@"List layout, serial: %.1fms", serialDuration * 1000);
+	
+	DemoBenchmarkLayoutDataSource *concurrentDataSource = [[DemoBenchmarkConcurrentLayoutDataSource alloc] init];
+	JNWCollectionViewListLayout *concurrentListLayout = [[JNWCollectionViewListLayout alloc] init];
+	concurrentListLayout.delegate = concurrentDataSource;
+	CFTimeInterval concurrentDuration = [self durationOfPreparingLayout:concurrentListLayout dataSource:concurrentDataSource];
+	NSLog(@"List layout, parallel: %.1fms (%.1fx)", concurrentDuration * 1000, serialDuration / concurrentDuration);
+	
+	JNWCollectionViewGridLayout *gridLayout = [[JNWCollectionViewGridLayout alloc] init];
+	gridLayout.itemSize = CGSizeMake(80, 80);
+	gridLayout.delegate = serialDataSource;
+	CFTimeInterval gridDuration = [self durationOfPreparingLayout:gridLayout dataSource:serialDataSource];
+	NSLog(@"Grid layout, parallel: %.1fms", gridDuration * 1000);
+}
+
+// Returns the shortest time it took to prepare the layout over several runs.
+- (CFTimeInterval)durationOfPreparingLayout:(JNWCollectionViewLayout *)layout dataSource:(id<JNWCollectionViewDataSource>)dataSource {
+	JNWCollectionView *collectionView = [[JNWCollectionView alloc] initWithFrame:NSMakeRect(0, 0, 800, 600)];
+	collectionView.collectionViewLayout = layout;
+	collectionView.dataSource = dataSource;
+	[collectionView reloadData];
+	
+	CFTimeInterval shortestDuration = DBL_MAX;
+	for (NSUInteger run = 0; run < DemoBenchmarkNumberOfLayoutRuns; run++) {
+		@autoreleasepool {
+			CFTimeInterval start = CACurrentMediaTime();
+			[layout prepareLayout];
+			shortestDuration = MIN(shortestDuration, CACurrentMediaTime() - start);
+		}
+	}
+	
+	return shortestDuration;
+}
+
+#pragma mark Thumbnail Cache
+
+- (void)runThumbnailCacheBenchmark {
+	NSArray *URLs = [self benchmarkImageURLs];
+	if (URLs == nil)
+		return;
+	
+	// Scroll speeds in items per frame, from browsing to flicking through the whole grid.
+	for (NSNumber *speed in @[ @1, @4, @16 ]) {
+		JNWCollectionViewThumbnailCache *cache = [[JNWCollectionViewThumbnailCache alloc] init];
+		CFTimeInterval duration = [self sweepThumbnailCache:cache URLs:URLs itemsPerFrame:speed.unsignedIntegerValue];
+		
+		NSUInteger requests = cache.numberOfHits + cache.numberOfMisses;
+		NSLog(@"Thumbnails at %@ items/frame: %lu requests, hit rate %.1f%%, %lu decodes in %.2fs (%.0f decodes/s)",
+			  speed, (unsigned long)requests, (requests > 0 ? 100.0 * cache.numberOfHits / requests : 0),
+			  (unsigned long)cache.numberOfDecodes, duration, cache.numberOfDecodes / duration);
+	}
+}
+
+// Moves the visible range down and back up the images, requesting thumbnails for the items that come
+// into view and cancelling the requests of those that leave it, and returns the time it took.
+- (CFTimeInterval)sweepThumbnailCache:(JNWCollectionViewThumbnailCache *)cache URLs:(NSArray *)URLs itemsPerFrame:(NSUInteger)itemsPerFrame {
+	NSMutableDictionary *tokens = [NSMutableDictionary dictionary];
+	NSUInteger lastFirstItem = URLs.count - DemoBenchmarkNumberOfVisibleItems;
+	NSRange visibleItems = NSMakeRange(0, 0);
+	CFTimeInterval start = CACurrentMediaTime();
+	
+	for (NSUInteger sweep = 0; sweep < DemoBenchmarkNumberOfSweeps; sweep++) {
+		BOOL down = (sweep % 2 == 0);
+		for (NSUInteger step = 0; step <= lastFirstItem; step += itemsPerFrame) {
+			NSUInteger firstItem = (down ? step : lastFirstItem - step);
+			NSRange newVisibleItems = NSMakeRange(firstItem, DemoBenchmarkNumberOfVisibleItems);
+			
+			for (NSUInteger item = visibleItems.location; item < NSMaxRange(visibleItems); item++) {
+				if (!NSLocationInRange(item, newVisibleItems) && tokens[@(item)] != nil) {
+					[cache cancelThumbnailRequest:tokens[@(item)]];
+					[tokens removeObjectForKey:@(item)];
+				}
+			}
+			
+			for (NSUInteger item = newVisibleItems.location; item < NSMaxRange(newVisibleItems); item++) {
+				if (NSLocationInRange(item, visibleItems))
+					continue;
+				
+				id token = [cache loadThumbnailForURL:URLs[item] size:DemoBenchmarkThumbnailSize scale:2 completionHandler:^(NSImage *thumbnail) {
+					[tokens removeObjectForKey:@(item)];
+				}];
+				if (token != nil) {
+					tokens[@(item)] = token;
+				}
+			}
+			
+			visibleItems = newVisibleItems;
+			[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.0 / 60]];
+		}
+	}
+	
+	// Let the thumbnails still in view finish, as they would on screen once scrolling stops.
+	while (tokens.count > 0) {
+		[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.0 / 60]];
+	}
+	
+	return CACurrentMediaTime() - start;
+}
+
+// Writes the benchmark images to a temporary directory the first time, and returns their URLs.
+- (NSArray *)benchmarkImageURLs {
+	NSURL *directory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"JNWCollectionViewDemoBenchmark"] isDirectory:YES];
+	NSError *error = nil;
+	if (![[NSFileManager defaultManager] createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:&error]) {
+		NSLog(@"Could not create the benchmark images: %@", error);
+		return nil;
+	}
+	
+	NSMutableArray *URLs = [NSMutableArray arrayWithCapacity:DemoBenchmarkNumberOfImages];
+	for (NSUInteger i = 0; i < DemoBenchmarkNumberOfImages; i++) {
+		NSURL *URL = [directory URLByAppendingPathComponent:[NSString stringWithFormat:@"%lu.jpg", (unsigned long)i]];
+		if (![URL checkResourceIsReachableAndReturnError:NULL]) {
+			NSData *data = [self JPEGDataForImageAtIndex:i];
+			if (![data writeToURL:URL options:NSDataWritingAtomic error:&error]) {
+				NSLog(@"Could not create the benchmark images: %@", error);
+				return nil;
+			}
+		}
+		[URLs addObject:URL];
+	}
+	
+	return URLs;
+}
+
+- (NSData *)JPEGDataForImageAtIndex:(NSUInteger)index {
+	NSBitmapImageRep *bitmap = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:DemoBenchmarkImageSize.width pixelsHigh:DemoBenchmarkImageSize.height bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:0 bitsPerPixel:0];
+	
+	[NSGraphicsContext saveGraphicsState];
+	[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithBitmapImageRep:bitmap]];
+	
+	// Enough detail that the JPEG isn't trivially small to decode.
+	srandom((unsigned)index);
+	for (NSUInteger i = 0; i < 200; i++) {
+		[[NSColor colorWithDeviceHue:(random() % 360) / 360.0 saturation:0.6 brightness:0.8 alpha:1] set];
+		NSRectFill(NSMakeRect(random() % (long)DemoBenchmarkImageSize.width, random() % (long)DemoBenchmarkImageSize.height, 40 + random() % 400, 40 + random() % 400));
+	}
+	
+	[NSGraphicsContext restoreGraphicsState];
+	
+	return [bitmap representationUsingType:NSJPEGFileType properties:@{ NSImageCompressionFactor: @0.8 }];
+}
+
+@end